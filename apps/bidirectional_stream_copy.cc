@@ -43,7 +43,7 @@ void bidirectional_stream_copy(Socket &socket) {
                         Direction::Out,
                         [&] {
                             const size_t bytes_to_write = min(max_copy_length, _outbound.buffer_size());
-                            const size_t bytes_written = socket.write(_outbound.peek_output(bytes_to_write), false);
+                            const size_t bytes_written = socket.write(_outbound.peek_views(bytes_to_write), false);
                             _outbound.pop_output(bytes_written);
                             if (_outbound.eof()) {
                                 socket.shutdown(SHUT_WR);
@@ -71,7 +71,7 @@ void bidirectional_stream_copy(Socket &socket) {
                         Direction::Out,
                         [&] {
                             const size_t bytes_to_write = min(max_copy_length, _inbound.buffer_size());
-                            const size_t bytes_written = _output.write(_inbound.peek_output(bytes_to_write), false);
+                            const size_t bytes_written = _output.write(_inbound.peek_views(bytes_to_write), false);
                             _inbound.pop_output(bytes_written);
 
                             if (_inbound.eof()) {
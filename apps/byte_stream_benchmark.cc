@@ -0,0 +1,55 @@
+#include "byte_stream.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t capacity = 1024 * 1024;
+
+//! Push `total` bytes through a ByteStream in writes of `write_size` bytes, draining it whenever it fills up
+void benchmark_writes(const size_t write_size, const size_t total) {
+    ByteStream stream{capacity};
+    const string chunk(write_size, 'x');
+    size_t bytes_received = 0;
+
+    const auto first_time = high_resolution_clock::now();
+
+    while (stream.bytes_written() < total) {
+        if (stream.remaining_capacity() < write_size) {
+            bytes_received += stream.read(stream.buffer_size()).size();
+        }
+        stream.write(chunk);
+    }
+    bytes_received += stream.read(stream.buffer_size()).size();
+
+    const auto final_time = high_resolution_clock::now();
+
+    if (bytes_received != stream.bytes_written()) {
+        throw runtime_error("bytes written vs. read don't match");
+    }
+
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+    const auto bytes_per_second = bytes_received * 1e9 / double(duration);
+
+    cout << fixed << setprecision(2);
+    cout << "ByteStream throughput with " << setw(5) << write_size << "-byte writes: " << setw(10)
+         << bytes_per_second / 1e6 << " MB/s\n";
+}
+
+int main() {
+    try {
+        benchmark_writes(1, 16 * 1024 * 1024);
+        benchmark_writes(1024, 512 * 1024 * 1024);
+        benchmark_writes(64 * 1024, 2048UL * 1024 * 1024);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
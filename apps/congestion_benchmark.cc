@@ -0,0 +1,220 @@
+#include "tcp_connection.hh"
+
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+// A simulated path in 1 ms steps: a 4 Mbit/s bottleneck with a drop-tail queue, 20 ms of propagation
+// delay each way (so a bandwidth-delay product of 20 kB), and random loss of segments, either one at a time
+// or in bursts of consecutive segments.
+constexpr size_t BOTTLENECK_BYTES_PER_MS = 500;
+constexpr size_t QUEUE_BYTES = 16'000;
+constexpr size_t SHALLOW_QUEUE_BYTES = 3'000;
+constexpr uint64_t ONE_WAY_DELAY = 20;
+constexpr size_t HEADER_BYTES = 40;  // IPv4 + TCP, counted against the bottleneck
+constexpr uint64_t DURATION = 30'000;
+
+//! How the sender repairs losses
+enum class Recovery {
+    RTO,             //!< only when the retransmission timer expires
+    FastRetransmit,  //!< also on three duplicate ACKs, one hole per round trip (NewReno)
+    Sack             //!< also from the receiver's SACK blocks, any number of holes per round trip
+};
+
+struct Result {
+    double goodput;      //!< Mbit/s
+    double recovery_ms;  //!< mean time from a segment being dropped until the receiver has assembled past it
+    size_t queue_drops;  //!< segments dropped because the bottleneck queue was full
+};
+
+//! Run a bulk transfer over the simulated path, where each loss event drops `burst` consecutive segments
+Result run(const TCPConfig::CongestionControl congestion_control,
+           const Recovery recovery,
+           const double loss_rate,
+           const size_t burst,
+           const size_t queue_capacity = QUEUE_BYTES,
+           const bool pacing = false) {
+    TCPConfig config;
+    config.pacing = pacing;
+    config.congestion_control = congestion_control;
+    config.rt_timeout = 200;
+    config.adaptive_rto = true;
+    config.fast_retransmit = recovery != Recovery::RTO;
+    config.sack = recovery == Recovery::Sack;
+    TCPConnection sender{config}, receiver{config};
+
+    mt19937 rng{144};
+    bernoulli_distribution lost{loss_rate};
+    size_t burst_left = 0;
+
+    deque<TCPSegment> queue;
+    size_t queue_bytes = 0;
+    size_t link_budget = 0;
+    deque<pair<uint64_t, TCPSegment>> forward, reverse;  // (arrival time, segment)
+    uint64_t delivered = 0;
+
+    // dropped segments, by the absolute seqno just past their end, with the time they were dropped
+    WrappingInt32 isn{0};
+    multimap<uint64_t, uint64_t> holes;
+    uint64_t recoveries = 0, recovery_time = 0;
+    size_t queue_drops = 0;
+
+    const auto wire_size = [](const TCPSegment &seg) { return seg.payload().size() + HEADER_BYTES; };
+
+    const auto step = [&](const uint64_t now) {
+        // sender -> bottleneck queue
+        while (not sender.segments_out().empty()) {
+            TCPSegment seg = move(sender.segments_out().front());
+            sender.segments_out().pop();
+            if (seg.header().syn) {
+                isn = seg.header().seqno;
+            }
+            bool dropped = false;
+            if (burst_left > 0) {
+                --burst_left;
+                dropped = true;
+            } else if (lost(rng)) {
+                burst_left = burst - 1;
+                dropped = true;
+            }
+            if (not dropped and queue_bytes + wire_size(seg) > queue_capacity) {
+                dropped = true;
+                ++queue_drops;
+            }
+            if (dropped) {
+                const uint64_t start = unwrap(seg.header().seqno, isn, receiver.inbound_stream().bytes_written());
+                holes.emplace(start + seg.length_in_sequence_space(), now);
+                continue;
+            }
+            queue_bytes += wire_size(seg);
+            queue.push_back(move(seg));
+        }
+
+        // bottleneck -> propagation delay -> receiver
+        link_budget += BOTTLENECK_BYTES_PER_MS;
+        while (not queue.empty() and wire_size(queue.front()) <= link_budget) {
+            link_budget -= wire_size(queue.front());
+            queue_bytes -= wire_size(queue.front());
+            forward.emplace_back(now + ONE_WAY_DELAY, move(queue.front()));
+            queue.pop_front();
+        }
+        if (queue.empty()) {
+            // an idle link does not save up capacity
+            link_budget = 0;
+        }
+        while (not forward.empty() and forward.front().first <= now) {
+            receiver.segment_received(forward.front().second);
+            forward.pop_front();
+        }
+
+        // the SYN, the assembled bytes, then the FIN
+        const ByteStream &inbound = receiver.inbound_stream();
+        const uint64_t assembled = 1 + inbound.bytes_written() + inbound.input_ended();
+        while (not holes.empty() and holes.begin()->first <= assembled) {
+            recovery_time += now - holes.begin()->second;
+            ++recoveries;
+            holes.erase(holes.begin());
+        }
+
+        delivered += receiver.inbound_stream().buffer_size();
+        receiver.inbound_stream().pop_output(receiver.inbound_stream().buffer_size());
+
+        // receiver -> propagation delay -> sender (the reverse path is uncongested and lossless)
+        while (not receiver.segments_out().empty()) {
+            reverse.emplace_back(now + ONE_WAY_DELAY, move(receiver.segments_out().front()));
+            receiver.segments_out().pop();
+        }
+        while (not reverse.empty() and reverse.front().first <= now) {
+            sender.segment_received(reverse.front().second);
+            reverse.pop_front();
+        }
+
+        sender.tick(1);
+        receiver.tick(1);
+    };
+
+    sender.connect();
+    uint64_t now = 0;
+    for (; now < DURATION; ++now) {
+        if (sender.remaining_outbound_capacity() > 0) {
+            sender.write(string(sender.remaining_outbound_capacity(), 'x'));
+        }
+        step(now);
+    }
+    const double goodput = delivered * 8.0 / DURATION / 1000;
+
+    // let both sides close cleanly
+    sender.end_input_stream();
+    receiver.end_input_stream();
+    for (; sender.active() or receiver.active(); ++now) {
+        step(now);
+    }
+
+    return {goodput, recoveries ? double(recovery_time) / recoveries : 0, queue_drops};
+}
+
+int main() {
+    try {
+        const double loss_rates[] = {0, 0.001, 0.01, 0.03};
+        const pair<const char *, TCPConfig::CongestionControl> algorithms[] = {
+            {"none ", TCPConfig::CongestionControl::None},
+            {"Reno ", TCPConfig::CongestionControl::Reno},
+            {"CUBIC", TCPConfig::CongestionControl::Cubic},
+            {"BBR  ", TCPConfig::CongestionControl::BBR}};
+
+        const pair<const char *, Recovery> recoveries[] = {{"     RTO only:", Recovery::RTO},
+                                                           {"  + fast retx:", Recovery::FastRetransmit},
+                                                           {"       + SACK:", Recovery::Sack}};
+
+        cout << "Bulk transfer over a " << BOTTLENECK_BYTES_PER_MS * 8 / 1000 << " Mbit/s, " << 2 * ONE_WAY_DELAY
+             << " ms RTT path with a " << QUEUE_BYTES / 1000 << " kB drop-tail queue:\n"
+             << "goodput in Mbit/s / mean time in ms to recover a dropped segment\n";
+        for (const size_t burst : {1, 4}) {
+            cout << "\n" << (burst == 1 ? "segments lost one at a time" : "segments lost in bursts of 4") << "\n";
+            cout << "          loss events:";
+            for (const double loss_rate : loss_rates) {
+                cout << setw(12) << fixed << setprecision(1) << loss_rate * 100 << "%";
+            }
+            cout << "\n";
+
+            for (const auto &[name, algorithm] : algorithms) {
+                for (const auto &[recovery_name, recovery] : recoveries) {
+                    cout << "  " << name << recovery_name;
+                    for (const double loss_rate : loss_rates) {
+                        const Result result = run(algorithm, recovery, loss_rate, burst);
+                        cout << setw(7) << setprecision(2) << result.goodput << " /" << setw(5) << setprecision(0)
+                             << result.recovery_ms;
+                    }
+                    cout << "\n";
+                }
+            }
+        }
+
+        // a queue of two segments overflows when a whole window is sent at once; pacing spreads the window
+        // over the RTT, so the queue only has to absorb the difference between the pacing and bottleneck rates
+        cout << "\nWith a " << SHALLOW_QUEUE_BYTES / 1000 << " kB drop-tail queue and SACK, no random loss:\n"
+             << "goodput in Mbit/s / segments dropped at the queue\n";
+        for (const auto &[name, algorithm] : algorithms) {
+            if (algorithm == TCPConfig::CongestionControl::None) {
+                continue;
+            }
+            for (const bool pacing : {false, true}) {
+                const Result result = run(algorithm, Recovery::Sack, 0, 1, SHALLOW_QUEUE_BYTES, pacing);
+                cout << "  " << name << (pacing ? "   paced:" : " unpaced:") << setw(7) << setprecision(2)
+                     << result.goodput << " /" << setw(5) << result.queue_drops << "\n";
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
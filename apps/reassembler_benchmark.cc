@@ -0,0 +1,125 @@
+#include "stream_reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t capacity = 1024 * 1024;
+constexpr size_t len = 64 * 1024 * 1024;
+constexpr size_t segment_size = 1460;
+
+//! (index, length) of each substring to push, in order
+using Pattern = vector<pair<size_t, size_t>>;
+
+//! The segments of each window's worth of the stream, in an order chosen by `arrange`
+template <typename T>
+Pattern by_window(const T &arrange) {
+    Pattern pattern;
+    for (size_t window = 0; window < len; window += capacity) {
+        Pattern segments;
+        for (size_t index = window; index < min(len, window + capacity); index += segment_size) {
+            segments.emplace_back(index, min(segment_size, len - index));
+        }
+        arrange(segments);
+        pattern.insert(pattern.end(), segments.begin(), segments.end());
+    }
+    return pattern;
+}
+
+//! Push `pattern` through a reassembler (reading the output between windows), and report the throughput
+void benchmark(const string &name, const Pattern &pattern, const string &data) {
+    cout << "  " << left << setw(12) << name << right;
+    for (const auto engine : {StreamReassembler::Engine::Map, StreamReassembler::Engine::Bitmap}) {
+        StreamReassembler reassembler{capacity, engine};
+        size_t bytes_received = 0;
+
+        const auto first_time = high_resolution_clock::now();
+
+        size_t window = 0;
+        for (const auto &[index, length] : pattern) {
+            if (index / capacity != window) {
+                bytes_received += reassembler.stream_out().read(reassembler.stream_out().buffer_size()).size();
+                window = index / capacity;
+            }
+            reassembler.push_substring(data.substr(index, length), index, index + length == len);
+        }
+        bytes_received += reassembler.stream_out().read(reassembler.stream_out().buffer_size()).size();
+
+        const auto final_time = high_resolution_clock::now();
+
+        if (bytes_received != len or not reassembler.stream_out().eof()) {
+            throw runtime_error(name + ": bytes received vs. sent don't match");
+        }
+
+        const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+        const auto fast_path_share =
+            100.0 * reassembler.fast_path_hits() / double(reassembler.fast_path_hits() + reassembler.slow_path_hits());
+        cout << fixed << setprecision(2) << setw(10) << len * 8.0 / double(duration) << " Gbit/s" << setprecision(0)
+             << " (" << setw(3) << fast_path_share << "% fast)";
+    }
+    cout << "\n";
+}
+
+int main() {
+    try {
+        string data(len, 0);
+        mt19937 rd{12345};
+        generate(data.begin(), data.end(), [&] { return rd(); });
+
+        const auto half_windows = [](Pattern &segments) {
+            const size_t half = segments.size() / 2;
+            Pattern rearranged{segments.begin() + half, segments.end()};
+            rearranged.insert(rearranged.end(), segments.begin(), segments.begin() + half);
+            segments = move(rearranged);
+        };
+
+        cout << "Reassembler throughput (" << capacity / 1024 << " KiB window)    Map"
+             << "                           Bitmap\n";
+
+        // in-order segments (fsm_stream_reassembler_seq)
+        benchmark("seq", by_window([](Pattern &) {}), data);
+
+        // every segment delivered twice (fsm_stream_reassembler_dup)
+        benchmark("dup", by_window([](Pattern &segments) {
+                      Pattern doubled;
+                      for (const auto &segment : segments) {
+                          doubled.push_back(segment);
+                          doubled.push_back(segment);
+                      }
+                      segments = move(doubled);
+                  }),
+                  data);
+
+        // the second half of each window before the first (fsm_stream_reassembler_holes)
+        benchmark("holes", by_window(half_windows), data);
+
+        // each window's segments in reverse order (tcp_benchmark with reordering)
+        benchmark("reverse", by_window([](Pattern &segments) { reverse(segments.begin(), segments.end()); }), data);
+
+        // segments that each overlap the next by half (fsm_stream_reassembler_overlapping)
+        benchmark("overlapping", by_window([](Pattern &segments) {
+                      for (auto &[index, length] : segments) {
+                          length = min(length + segment_size / 2, len - index);
+                      }
+                      reverse(segments.begin(), segments.end());
+                  }),
+                  data);
+
+        // each window's segments shuffled (fsm_stream_reassembler_many)
+        benchmark("many", by_window([&](Pattern &segments) { shuffle(segments.begin(), segments.end(), rd); }), data);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include "spsc_byte_stream.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t len = 1024 * 1024 * 1024;
+constexpr size_t chunk_size = 64 * 1024;
+
+void report(const string &name, const high_resolution_clock::time_point first_time) {
+    const auto final_time = high_resolution_clock::now();
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+    const auto gigabits_per_second = len * 8.0 / double(duration);
+
+    cout << fixed << setprecision(2);
+    cout << "Two-thread handoff through " << name << ": " << gigabits_per_second << " Gbit/s\n";
+}
+
+//! Move `len` bytes from one thread to another in 64 KiB chunks through an SPSCByteStream
+void benchmark_spsc() {
+    SPSCByteStream stream{1024 * 1024};
+    const string chunk(chunk_size, 'x');
+
+    const auto first_time = high_resolution_clock::now();
+
+    thread writer([&] {
+        size_t written = 0;
+        while (written < len) {
+            const size_t n = stream.write(chunk.data(), min(chunk_size, len - written));
+            if (n == 0) {
+                stream.wait_until_writable();
+            }
+            written += n;
+        }
+        stream.end_input();
+    });
+
+    string buf(chunk_size, 0);
+    size_t received = 0;
+    while (not stream.eof()) {
+        const size_t n = stream.read_into(buf.data(), buf.size());
+        if (n == 0) {
+            stream.wait_until_readable();
+        }
+        received += n;
+    }
+    writer.join();
+
+    if (received != len) {
+        throw runtime_error("bytes sent vs. received don't match");
+    }
+    report("SPSCByteStream", first_time);
+}
+
+//! Move `len` bytes from one thread to another in 64 KiB chunks through a Unix-domain socketpair
+void benchmark_socketpair() {
+    int fds[2];
+    SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, static_cast<int *>(fds)));
+    FileDescriptor sender{fds[0]}, receiver{fds[1]};
+    const string chunk(chunk_size, 'x');
+
+    const auto first_time = high_resolution_clock::now();
+
+    thread writer([&] {
+        size_t written = 0;
+        while (written < len) {
+            written += sender.write(chunk.substr(0, min(chunk_size, len - written)));
+        }
+        sender.close();
+    });
+
+    string buf(chunk_size, 0);
+    size_t received = 0;
+    while (true) {
+        const auto n = SystemCall("read", ::read(receiver.fd_num(), buf.data(), buf.size()));
+        if (n == 0) {
+            break;
+        }
+        received += n;
+    }
+    writer.join();
+
+    if (received != len) {
+        throw runtime_error("bytes sent vs. received don't match");
+    }
+    report("socketpair    ", first_time);
+}
+
+int main() {
+    try {
+        benchmark_spsc();
+        benchmark_socketpair();
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
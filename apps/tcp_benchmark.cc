@@ -1,16 +1,26 @@
+#include "ipv4_header.hh"
 #include "tcp_connection.hh"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
+#include <deque>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <string>
+#include <utility>
 
 using namespace std;
 using namespace std::chrono;
 
 constexpr size_t len = 100 * 1024 * 1024;
 
+// the path for rtt_loop(): a round-trip time in ms, with no bandwidth limit, and no loss except of datagrams
+// larger than its MTU
+constexpr uint64_t rtt = 50;
+constexpr uint64_t simulated_time = 5'000;
+
 void move_segments(TCPConnection &x, TCPConnection &y, vector<TCPSegment> &segments, const bool reorder) {
     while (not x.segments_out().empty()) {
         segments.emplace_back(move(x.segments_out().front()));
@@ -28,8 +38,9 @@ void move_segments(TCPConnection &x, TCPConnection &y, vector<TCPSegment> &segme
     segments.clear();
 }
 
-void main_loop(const bool reorder) {
+void main_loop(const bool reorder, const uint16_t mss = TCPConfig::MAX_PAYLOAD_SIZE) {
     TCPConfig config;
+    config.mss = mss;
     TCPConnection x{config}, y{config};
 
     string string_to_send(len, 'x');
@@ -52,7 +63,9 @@ void main_loop(const bool reorder) {
         // write input into x
         while (bytes_to_send.size() and x.remaining_outbound_capacity()) {
             const auto want = min(x.remaining_outbound_capacity(), bytes_to_send.size());
-            const auto written = x.write(string(bytes_to_send.str().substr(0, want)));
+            Buffer chunk = bytes_to_send;
+            chunk.remove_suffix(bytes_to_send.size() - want);
+            const auto written = x.write(move(chunk));
             if (want != written) {
                 throw runtime_error("want = " + to_string(want) + ", written = " + to_string(written));
             }
@@ -94,19 +107,139 @@ void main_loop(const bool reorder) {
 
     const auto gigabits_per_second = len * 8.0 / double(duration);
 
+    const auto bytes_copied = x.outbound_stream().bytes_copied() + y.inbound_stream().bytes_copied();
+    const auto copies_per_byte = bytes_copied / double(len);
+
     cout << fixed << setprecision(2);
-    cout << "CPU-limited throughput" << (reorder ? " with reordering: " : "                : ") << gigabits_per_second
-         << " Gbit/s\n";
+    cout << "CPU-limited throughput with MSS " << setw(4) << mss
+         << (reorder ? " and reordering: " : ":                ") << gigabits_per_second << " Gbit/s, "
+         << copies_per_byte << " ByteStream copies per byte delivered\n";
 
     while (x.active() or y.active()) {
         loop();
     }
 }
 
+//! A sender and receiver with windows of `capacity` bytes
+TCPConfig window_config(const size_t capacity, const bool window_scaling) {
+    TCPConfig config;
+    config.recv_capacity = capacity;
+    config.send_capacity = capacity;
+    config.window_scaling = window_scaling;
+    return config;
+}
+
+//! Large scaled windows, so that segment size is all that varies, and SACK to recover from failed MTU probes
+TCPConfig mss_config(const uint16_t mss, const bool mtu_probing) {
+    TCPConfig config = window_config(4'000'000, true);
+    config.adaptive_rto = true;
+    config.fast_retransmit = true;
+    config.sack = true;
+    config.mss = mss;
+    config.mtu_probing = mtu_probing;
+    return config;
+}
+
+//! As mss_config(1460), acknowledging every `segments` full segments
+TCPConfig delayed_ack_config(const unsigned segments) {
+    TCPConfig config = mss_config(1460, false);
+    config.delayed_ack_segments = segments;
+    return config;
+}
+
+//! Windows that start at 64 kB and grow with autotuning up to 4000 kB
+TCPConfig autotuning_config() {
+    TCPConfig config = window_config(4'000'000, true);
+    config.recv_capacity = TCPConfig::DEFAULT_CAPACITY;
+    config.recv_autotuning = true;
+    return config;
+}
+
+//! A bulk transfer over a path with `rtt` ms of delay, in 1 ms steps, where only the window limits throughput
+void rtt_loop(const string &description,
+              const TCPConfig &config,
+              const size_t path_mtu = numeric_limits<size_t>::max()) {
+    TCPConnection x{config}, y{config};
+
+    deque<pair<uint64_t, TCPSegment>> forward, reverse;  // (arrival time, segment)
+    size_t delivered = 0;
+    size_t segments = 0, largest = 0;  // data segments that got through
+    size_t acks = 0;                   // segments the receiver sent
+
+    const auto step = [&](const uint64_t now) {
+        while (not x.segments_out().empty()) {
+            TCPSegment seg = move(x.segments_out().front());
+            x.segments_out().pop();
+            if (IPv4Header::LENGTH + seg.header().doff * 4 + seg.payload().size() > path_mtu) {
+                continue;
+            }
+            if (seg.payload().size() > 0) {
+                ++segments;
+                largest = max(largest, seg.payload().size());
+            }
+            forward.emplace_back(now + rtt / 2, move(seg));
+        }
+        // the application reads as soon as data arrives, so the receive window stays open
+        while (not forward.empty() and forward.front().first <= now) {
+            y.segment_received(forward.front().second);
+            forward.pop_front();
+            delivered += y.inbound_stream().buffer_size();
+            y.inbound_stream().pop_output(y.inbound_stream().buffer_size());
+        }
+
+        while (not y.segments_out().empty()) {
+            ++acks;
+            reverse.emplace_back(now + rtt / 2, move(y.segments_out().front()));
+            y.segments_out().pop();
+        }
+        while (not reverse.empty() and reverse.front().first <= now) {
+            x.segment_received(reverse.front().second);
+            reverse.pop_front();
+        }
+
+        x.tick(1);
+        y.tick(1);
+    };
+
+    x.connect();
+    uint64_t now = 0;
+    for (; now < simulated_time; ++now) {
+        if (x.remaining_outbound_capacity() > 0) {
+            x.write(string(x.remaining_outbound_capacity(), 'x'));
+        }
+        step(now);
+    }
+
+    cout << fixed << setprecision(2);
+    cout << "Over a " << rtt << " ms RTT, " << left << setw(40) << description + ":" << right << setw(7)
+         << delivered * 8.0 / simulated_time / 1000 << " Mbit/s, " << setw(6) << setprecision(1)
+         << segments * 1e6 / delivered << " segments and " << setw(6) << acks * 1e6 / delivered
+         << " ACKs per MB, largest " << largest << " bytes\n";
+
+    x.end_input_stream();
+    y.end_input_stream();
+    for (; x.active() or y.active(); ++now) {
+        step(now);
+    }
+}
+
 int main() {
     try {
         main_loop(false);
         main_loop(true);
+        main_loop(false, 1460);
+        main_loop(false, 8960);
+        rtt_loop("64 kB windows", window_config(TCPConfig::DEFAULT_CAPACITY, false));
+        rtt_loop("4000 kB windows", window_config(4'000'000, false));
+        rtt_loop("4000 kB windows and window scaling", window_config(4'000'000, true));
+        rtt_loop("64 kB windows autotuned up to 4000 kB", autotuning_config());
+        rtt_loop("1500-byte MTU, MSS 1000", mss_config(1000, false), 1500);
+        rtt_loop("1500-byte MTU, MSS 1460", mss_config(1460, false), 1500);
+        rtt_loop("1500-byte MTU, MSS up to 8960, probed", mss_config(8960, true), 1500);
+        rtt_loop("9000-byte MTU, MSS up to 8960, probed", mss_config(8960, true), 9000);
+        rtt_loop("MSS 1460, an ACK per segment", mss_config(1460, false), 1500);
+        rtt_loop("MSS 1460, an ACK per 2 segments", delayed_ack_config(2), 1500);
+        rtt_loop("MSS 1460, an ACK per 8 segments", delayed_ack_config(8), 1500);
     } catch (const exception &e) {
         cerr << e.what() << "\n";
         return EXIT_FAILURE;
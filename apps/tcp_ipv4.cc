@@ -32,10 +32,14 @@ static void show_usage(const char *argv0, const char *msg) {
 
          << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
 
+         << "   -m <mss>        Send segments of up to <mss> bytes              " << TCPConfig::MAX_PAYLOAD_SIZE << "\n"
+         << "   -P              Probe for the path MTU (RFC 4821)               (off)\n\n"
+
          << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
          << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
-         << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n\n"
+         << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n"
+         << "   -Lm <mtu>       Drop datagrams larger than <mtu> bytes          (no limit)\n\n"
 
          << "   -h              Show this message.\n\n";
 
@@ -109,6 +113,20 @@ static tuple<TCPConfig, FdAdapterConfig, bool, char *> get_config(int argc, char
                 static_cast<LossRateDnT>(static_cast<float>(numeric_limits<LossRateDnT>::max()) * lossrate);
             curr += 2;
 
+        } else if (strncmp("-m", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -m requires one argument.");
+            c_fsm.mss = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
+        } else if (strncmp("-P", argv[curr], 3) == 0) {
+            c_fsm.mtu_probing = true;
+            curr += 1;
+
+        } else if (strncmp("-Lm", argv[curr], 4) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -Lm requires one argument.");
+            c_filt.mtu = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
         } else if (strncmp("-h", argv[curr], 3) == 0) {
             show_usage(argv[0], nullptr);
             exit(0);
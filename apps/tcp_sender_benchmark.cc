@@ -0,0 +1,71 @@
+#include "tcp_sender.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t in_flight = 10'000;
+constexpr size_t rounds = 1'000'000;
+
+//! Keep `in_flight` one-byte segments outstanding; each round acknowledges the oldest and sends one more
+void benchmark_acks() {
+    const WrappingInt32 isn{0};
+    TCPSender sender{in_flight + rounds, TCPConfig::TIMEOUT_DFLT, isn};
+
+    const auto drain = [&] {
+        while (not sender.segments_out().empty()) {
+            sender.segments_out().pop();
+        }
+    };
+
+    // SYN
+    sender.fill_window();
+    sender.ack_received(wrap(1, isn), 65535);
+    drain();
+
+    for (size_t i = 0; i < in_flight; ++i) {
+        sender.stream_in().write(string(1, 'x'));
+        sender.fill_window();
+    }
+    drain();
+    if (sender.bytes_in_flight() != in_flight) {
+        throw runtime_error("expected " + to_string(in_flight) + " segments in flight");
+    }
+
+    const auto first_time = high_resolution_clock::now();
+
+    for (size_t i = 0; i < rounds; ++i) {
+        sender.ack_received(wrap(2 + i, isn), 65535);
+        sender.stream_in().write(string(1, 'x'));
+        sender.fill_window();
+        drain();
+    }
+
+    const auto final_time = high_resolution_clock::now();
+
+    if (sender.bytes_in_flight() != in_flight) {
+        throw runtime_error("segments in flight changed during the benchmark");
+    }
+
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+
+    cout << fixed << setprecision(1);
+    cout << "TCPSender with " << in_flight << " segments in flight: " << double(duration) / rounds
+         << " ns per ACK + send\n";
+}
+
+int main() {
+    try {
+        benchmark_acks();
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -13,6 +13,7 @@ add_test(NAME t_recv_window          COMMAND recv_window)
 add_test(NAME t_recv_reorder         COMMAND recv_reorder)
 add_test(NAME t_recv_close           COMMAND recv_close)
 add_test(NAME t_recv_special         COMMAND recv_special)
+add_test(NAME t_recv_autotuning      COMMAND recv_autotuning)
 
 add_test(NAME t_send_connect         COMMAND send_connect)
 add_test(NAME t_send_transmit        COMMAND send_transmit)
@@ -21,6 +22,12 @@ add_test(NAME t_send_window          COMMAND send_window)
 add_test(NAME t_send_ack             COMMAND send_ack)
 add_test(NAME t_send_close           COMMAND send_close)
 add_test(NAME t_send_extra           COMMAND send_extra)
+add_test(NAME t_send_congestion_control COMMAND send_congestion_control)
+add_test(NAME t_send_adaptive_rto     COMMAND send_adaptive_rto)
+add_test(NAME t_send_fast_retransmit  COMMAND send_fast_retransmit)
+add_test(NAME t_send_sack            COMMAND send_sack)
+add_test(NAME t_send_mss             COMMAND send_mss)
+add_test(NAME t_send_pacing          COMMAND send_pacing)
 
 add_test(NAME t_strm_reassem_single      COMMAND fsm_stream_reassembler_single)
 add_test(NAME t_strm_reassem_seq         COMMAND fsm_stream_reassembler_seq)
@@ -30,12 +37,17 @@ add_test(NAME t_strm_reassem_many        COMMAND fsm_stream_reassembler_many)
 add_test(NAME t_strm_reassem_overlapping COMMAND fsm_stream_reassembler_overlapping)
 add_test(NAME t_strm_reassem_win         COMMAND fsm_stream_reassembler_win)
 add_test(NAME t_strm_reassem_cap         COMMAND fsm_stream_reassembler_cap)
+add_test(NAME t_strm_reassem_bitmap      COMMAND fsm_stream_reassembler_bitmap)
+add_test(NAME t_strm_reassem_buffer      COMMAND fsm_stream_reassembler_buffer)
 
 add_test(NAME t_byte_stream_construction COMMAND byte_stream_construction)
 add_test(NAME t_byte_stream_one_write    COMMAND byte_stream_one_write)
 add_test(NAME t_byte_stream_two_writes   COMMAND byte_stream_two_writes)
 add_test(NAME t_byte_stream_capacity     COMMAND byte_stream_capacity)
 add_test(NAME t_byte_stream_many_writes  COMMAND byte_stream_many_writes)
+add_test(NAME t_byte_stream_chunked      COMMAND byte_stream_chunked)
+add_test(NAME t_byte_stream_read_into    COMMAND byte_stream_read_into)
+add_test(NAME t_spsc_byte_stream        COMMAND spsc_byte_stream)
 
 add_test(NAME t_webget               COMMAND "${PROJECT_SOURCE_DIR}/tests/webget_t.sh")
 
@@ -44,6 +56,10 @@ add_test(NAME arp_network_interface    COMMAND net_interface)
 add_test(NAME router_test    COMMAND network_simulator)
 
 add_test(NAME t_tcp_parser           COMMAND tcp_parser "${PROJECT_SOURCE_DIR}/tests/ipv4_parser.data")
+add_test(NAME t_tcp_options          COMMAND tcp_options)
+add_test(NAME t_internet_checksum    COMMAND internet_checksum)
+add_test(NAME t_tcp_serialize        COMMAND tcp_serialize)
+add_test(NAME t_buffer_pool          COMMAND buffer_pool)
 add_test(NAME t_ipv4_parser          COMMAND ipv4_parser "${PROJECT_SOURCE_DIR}/tests/ipv4_parser.data")
 add_test(NAME t_active_close         COMMAND fsm_active_close)
 add_test(NAME t_passive_close        COMMAND fsm_passive_close)
@@ -56,6 +72,9 @@ add_test(NAME t_connect              COMMAND fsm_connect_relaxed)
 add_test(NAME ec_listen              COMMAND fsm_listen)
 add_test(NAME t_listen               COMMAND fsm_listen_relaxed)
 add_test(NAME t_winsize              COMMAND fsm_winsize)
+add_test(NAME t_window_scale         COMMAND fsm_window_scale)
+add_test(NAME t_sack                 COMMAND fsm_sack)
+add_test(NAME t_delayed_ack          COMMAND fsm_delayed_ack)
 add_test(NAME ec_retx                COMMAND fsm_retx)
 add_test(NAME t_retx                 COMMAND fsm_retx_relaxed)
 add_test(NAME t_retx_win             COMMAND fsm_retx_win)
@@ -1,75 +1,231 @@
 #include "byte_stream.hh"
 
-// Dummy implementation of a flow-controlled in-memory byte stream.
+#include <algorithm>
+#include <cstring>
 
-// For Lab 0, please replace with a real implementation that passes the
-// automated checks run by `make check_lab0`.
+// Flow-controlled in-memory byte stream.
 
-// You will need to add private members to the class declaration in `byte_stream.hh`
+// With Storage::Ring, bytes live in a ring buffer of `capacity` bytes and every operation
+// moves them with at most two memcpy calls: one up to the end of the ring and one (only if
+// the region wraps around) from the start of the ring.
 
-template <typename... Targs>
-void DUMMY_CODE(Targs &&.../* unused */) {}
+// With Storage::Chunked, each write is kept as its own refcounted Buffer, so readers can
+// take slices of the written data (e.g. as TCP segment payloads) without copying them.
 
 using namespace std;
 
-ByteStream::ByteStream(const size_t capacity) : _capacity(capacity) { DUMMY_CODE(capacity);}
+ByteStream::ByteStream(const size_t capacity, const Storage storage)
+    : _storage(storage), _buffer(storage == Storage::Ring ? capacity : 0), _capacity(capacity) {}
 
-size_t ByteStream::write(const string &data) {
-    DUMMY_CODE(data);
-    auto write_len = min(remaining_capacity(), data.size());
-    for (size_t i = 0; i < write_len; i++) {
-        _buffer.push_back(data[i]);
+void ByteStream::_copy_in(const char *data, const size_t len) {
+    size_t tail = _head + _size;
+    if (tail >= _capacity) {
+        tail -= _capacity;
     }
+    const size_t first = min(len, _capacity - tail);
+    memcpy(_buffer.data() + tail, data, first);
+    memcpy(_buffer.data(), data + first, len - first);
+}
+
+size_t ByteStream::write(const string &data) { return write(data.data(), data.size()); }
+
+size_t ByteStream::write(const char *data, const size_t len) {
+    const size_t write_len = min(remaining_capacity(), len);
+    if (write_len == 0) {
+        return 0;
+    }
+    if (_storage == Storage::Chunked) {
+        _chunks.emplace_back(string(data, write_len));
+    } else {
+        _copy_in(data, write_len);
+    }
+    _size += write_len;
+    _write_total += write_len;
+    _copy_total += write_len;
+    return write_len;
+}
+
+size_t ByteStream::write(string &&data) {
+    if (_storage == Storage::Ring) {
+        return write(data);
+    }
+    const size_t write_len = min(remaining_capacity(), data.size());
+    if (write_len == 0) {
+        return 0;
+    }
+    data.resize(write_len);
+    _chunks.emplace_back(move(data));
+    _size += write_len;
+    _write_total += write_len;
+    return write_len;
+}
+
+size_t ByteStream::write(Buffer data) {
+    const size_t write_len = min(remaining_capacity(), data.size());
+    if (write_len == 0) {
+        return 0;
+    }
+    if (_storage == Storage::Chunked) {
+        data.remove_suffix(data.size() - write_len);
+        _chunks.push_back(move(data));
+    } else {
+        _copy_in(data.str().data(), write_len);
+        _copy_total += write_len;
+    }
+    _size += write_len;
     _write_total += write_len;
     return write_len;
 }
 
 //! \param[in] len bytes will be copied from the output side of the buffer
 string ByteStream::peek_output(const size_t len) const {
-    DUMMY_CODE(len);
-    string ret{};
-    for (size_t i = 0; i < len; i++) {
-        ret += _buffer[i];
-    }
+    string ret(min(len, _size), 0);
+    peek_into(ret.data(), ret.size());
     return ret;
 }
 
+//! \param[out] dest memory with room for at least `len` bytes
+//! \param[in] len bytes will be copied from the output side of the buffer
+size_t ByteStream::peek_into(char *dest, const size_t len) const {
+    const size_t peek_len = min(len, _size);
+    _copy_total += peek_len;
+    if (_storage == Storage::Chunked) {
+        size_t copied = 0;
+        for (auto it = _chunks.begin(); copied < peek_len; ++it) {
+            const size_t n = min(peek_len - copied, it->size());
+            memcpy(dest + copied, it->str().data(), n);
+            copied += n;
+        }
+        return peek_len;
+    }
+    const size_t first = min(peek_len, _capacity - _head);
+    memcpy(dest, _buffer.data() + _head, first);
+    memcpy(dest + first, _buffer.data(), peek_len - first);
+    return peek_len;
+}
+
+//! \param[out] dest memory with room for at least `len` bytes
+//! \param[in] len bytes will be popped and copied into `dest`
+size_t ByteStream::read_into(char *dest, const size_t len) {
+    const size_t read_len = peek_into(dest, len);
+    pop_output(read_len);
+    return read_len;
+}
+
+//! \param[in] len bytes will be exposed from the output side of the buffer
+//! \returns a BufferViewList whose total size is min(len, buffer_size())
+BufferViewList ByteStream::peek_views(const size_t len) const {
+    deque<string_view> views;
+    size_t remaining = min(len, _size);
+    if (_storage == Storage::Chunked) {
+        for (auto it = _chunks.begin(); remaining > 0; ++it) {
+            const size_t n = min(remaining, it->size());
+            views.emplace_back(it->str().data(), n);
+            remaining -= n;
+        }
+        return views;
+    }
+    const size_t first = min(remaining, _capacity - _head);
+    if (first > 0) {
+        views.emplace_back(_buffer.data() + _head, first);
+    }
+    if (remaining > first) {
+        views.emplace_back(_buffer.data(), remaining - first);
+    }
+    return views;
+}
+
 //! \param[in] len bytes will be removed from the output side of the buffer
-void ByteStream::pop_output(const size_t len) { DUMMY_CODE(len);
-    for (size_t i = 0; i < len; i++) {
-        _buffer.pop_front();
+void ByteStream::pop_output(const size_t len) {
+    const size_t pop_len = min(len, _size);
+    if (_storage == Storage::Chunked) {
+        size_t remaining = pop_len;
+        while (remaining > 0) {
+            if (remaining < _chunks.front().size()) {
+                _chunks.front().remove_prefix(remaining);
+                break;
+            }
+            remaining -= _chunks.front().size();
+            _chunks.pop_front();
+        }
+    } else {
+        _head += pop_len;
+        if (_head >= _capacity) {
+            _head -= _capacity;
+        }
+        if (_size == pop_len) {
+            // keep the next write contiguous when the stream drains
+            _head = 0;
+        }
     }
-    _read_total += len;
+    _size -= pop_len;
+    _read_total += pop_len;
 }
 
 //! Read (i.e., copy and then pop) the next "len" bytes of the stream
 //! \param[in] len bytes will be popped and returned
 //! \returns a string
 std::string ByteStream::read(const size_t len) {
-    DUMMY_CODE(len);
     auto ret = peek_output(len);
-    pop_output(len);
+    pop_output(ret.size());
     return ret;
 }
 
-void ByteStream::end_input() {
-    _has_ended = true;
+//! \param[in] len bytes will be returned from the output side of the buffer
+//! \returns a BufferList whose total size is min(len, buffer_size())
+BufferList ByteStream::peek_buffers(const size_t len) const {
+    if (_storage == Storage::Ring) {
+        return BufferList{peek_output(len)};
+    }
+    BufferList ret;
+    size_t remaining = min(len, _size);
+    for (auto it = _chunks.begin(); remaining > 0; ++it) {
+        Buffer slice = *it;
+        if (remaining < slice.size()) {
+            slice.remove_suffix(slice.size() - remaining);
+        }
+        remaining -= slice.size();
+        ret.append(slice);
+    }
+    return ret;
 }
 
-bool ByteStream::input_ended() const {
-    return _has_ended;
+//! \param[in] len bytes will be popped and returned
+//! \returns a Buffer of min(len, buffer_size()) bytes
+Buffer ByteStream::read_buffer(const size_t len) {
+    const size_t read_len = min(len, _size);
+    if (_storage == Storage::Ring or read_len == 0 or read_len > _chunks.front().size()) {
+        return read(read_len);
+    }
+    Buffer slice = _chunks.front();
+    slice.remove_suffix(slice.size() - read_len);
+    pop_output(read_len);
+    return slice;
 }
 
-size_t ByteStream::buffer_size() const { return _buffer.size(); }
+void ByteStream::end_input() { _has_ended = true; }
 
-bool ByteStream::buffer_empty() const { return _buffer.empty(); }
+bool ByteStream::input_ended() const { return _has_ended; }
 
-bool ByteStream::eof() const {
-    return  _has_ended && _buffer.empty();
-}
+size_t ByteStream::buffer_size() const { return _size; }
+
+bool ByteStream::buffer_empty() const { return _size == 0; }
+
+bool ByteStream::eof() const { return _has_ended && _size == 0; }
 
 size_t ByteStream::bytes_written() const { return _write_total; }
 
 size_t ByteStream::bytes_read() const { return _read_total; }
 
-size_t ByteStream::remaining_capacity() const { return _capacity - _buffer.size(); }
+size_t ByteStream::remaining_capacity() const { return _capacity - _size; }
+
+void ByteStream::set_capacity(const size_t capacity) {
+    const size_t new_capacity = max(capacity, _size);
+    if (_storage == Storage::Ring) {
+        vector<char> buffer(new_capacity);
+        peek_into(buffer.data(), _size);
+        _buffer = move(buffer);
+        _head = 0;
+    }
+    _capacity = new_capacity;
+}
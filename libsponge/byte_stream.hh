@@ -1,8 +1,11 @@
 #ifndef SPONGE_LIBSPONGE_BYTE_STREAM_HH
 #define SPONGE_LIBSPONGE_BYTE_STREAM_HH
 
-#include <string>
+#include "buffer.hh"
+
 #include <deque>
+#include <string>
+#include <vector>
 
 //! \brief An in-order byte stream.
 
@@ -10,24 +13,38 @@
 //! side.  The byte stream is finite: the writer can end the input,
 //! and then no more bytes can be written.
 class ByteStream {
+  public:
+    //! How the buffered bytes are stored
+    enum class Storage {
+        Ring,    //!< Copy written bytes into a preallocated ring of `capacity` bytes
+        Chunked  //!< Keep each write as a refcounted Buffer and hand out slices of it without copying
+    };
+
   private:
-    // Your code here -- add private members as necessary.
-    std::deque<char>  _buffer{};
+    Storage _storage;
+
+    //! Ring storage of `_capacity` bytes; the buffered bytes start at `_head` and may wrap around
+    std::vector<char> _buffer{};
+
+    //! Chunked storage: the buffered bytes, in order, as a queue of Buffers
+    std::deque<Buffer> _chunks{};
+
     size_t _capacity{};
+    size_t _head{};  //!< Index in `_buffer` of the next byte to be read
+    size_t _size{};  //!< Number of bytes currently buffered
     bool _has_ended{};
     size_t _read_total{};
     size_t _write_total{};
+    mutable size_t _copy_total{};  //!< Bytes copied into or out of the stream's own storage
 
-    // Hint: This doesn't need to be a sophisticated data structure at
-    // all, but if any of your tests are taking longer than a second,
-    // that's a sign that you probably want to keep exploring
-    // different approaches.
+    //! Copy `len` bytes from `data` into the free space after the buffered bytes (at most two memcpys)
+    void _copy_in(const char *data, const size_t len);
 
     bool _error{};  //!< Flag indicating that the stream suffered an error.
 
   public:
     //! Construct a stream with room for `capacity` bytes.
-    ByteStream(const size_t capacity);
+    ByteStream(const size_t capacity, const Storage storage = Storage::Ring);
 
     //! \name "Input" interface for the writer
     //!@{
@@ -37,9 +54,28 @@ class ByteStream {
     //! \returns the number of bytes accepted into the stream
     size_t write(const std::string &data);
 
+    //! Write `len` bytes from `data` into the stream. Write as many
+    //! as will fit, and return how many were written.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(const char *data, const size_t len);
+
+    //! Write a string of bytes into the stream, taking ownership of it
+    //! \note With Storage::Chunked the string becomes a chunk without being copied
+    //! \returns the number of bytes accepted into the stream
+    size_t write(std::string &&data);
+
+    //! Write a Buffer into the stream, sharing its storage
+    //! \note With Storage::Chunked the Buffer becomes a chunk without being copied
+    //! \returns the number of bytes accepted into the stream
+    size_t write(Buffer data);
+
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
 
+    //! Change how many bytes the stream has room for (never to less than it holds)
+    //! \note With Storage::Ring the buffered bytes are copied into a ring of the new size
+    void set_capacity(const size_t capacity);
+
     //! Signal that the byte stream has reached its ending
     void end_input();
 
@@ -61,6 +97,29 @@ class ByteStream {
     //! \returns a string
     std::string read(const size_t len);
 
+    //! Peek at next "len" bytes of the stream as a list of Buffers
+    //! \note With Storage::Chunked the Buffers share storage with the stream (no copy)
+    BufferList peek_buffers(const size_t len) const;
+
+    //! Copy the next "len" bytes of the stream into caller-owned memory (without popping them)
+    //! \returns the number of bytes copied, min(len, buffer_size())
+    size_t peek_into(char *dest, const size_t len) const;
+
+    //! Read (i.e., copy and then pop) the next "len" bytes of the stream into caller-owned memory
+    //! \returns the number of bytes read, min(len, buffer_size())
+    size_t read_into(char *dest, const size_t len);
+
+    //! Views of the next "len" bytes of the stream, pointing directly into its storage
+    //! \note The views are invalidated by the next write or pop
+    BufferViewList peek_views(const size_t len) const;
+
+    //! The regions returned by peek_views(), ready for [writev(2)](\ref man2::writev)
+    std::vector<iovec> peek_iovecs(const size_t len) const { return peek_views(len).as_iovecs(); }
+
+    //! Read (i.e., slice and then pop) the next "len" bytes of the stream as a single Buffer
+    //! \note With Storage::Chunked this only copies if the bytes span more than one written chunk
+    Buffer read_buffer(const size_t len);
+
     //! \returns `true` if the stream input has ended
     bool input_ended() const;
 
@@ -85,6 +144,12 @@ class ByteStream {
 
     //! Total number of bytes popped
     size_t bytes_read() const;
+
+    //! Total number of bytes copied into or out of the stream's storage (rather than handed over as a Buffer)
+    size_t bytes_copied() const { return _copy_total; }
+
+    //! Count `len` bytes copied on the way into the stream (e.g., by a StreamReassembler holding them)
+    void count_copied(const size_t len) { _copy_total += len; }
     //!@}
 };
 
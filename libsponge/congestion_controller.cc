@@ -0,0 +1,233 @@
+#include "congestion_controller.hh"
+
+#include <algorithm>
+#include <cmath>
+
+// Congestion controllers for the TCPSender.
+
+// All windows and byte counts are in sequence space, and all times are in the milliseconds of the
+// TCPSender's clock (the sum of its tick() arguments).
+
+using namespace std;
+
+unique_ptr<CongestionController> CongestionController::make(const TCPConfig::CongestionControl algorithm,
+                                                            const size_t mss) {
+    switch (algorithm) {
+        case TCPConfig::CongestionControl::Reno:
+            return make_unique<RenoController>(mss);
+        case TCPConfig::CongestionControl::Cubic:
+            return make_unique<CubicController>(mss);
+        case TCPConfig::CongestionControl::BBR:
+            return make_unique<BBRController>(mss);
+        default:
+            return nullptr;
+    }
+}
+
+uint64_t CongestionController::_initial_window() const {
+    return min<uint64_t>(4 * _mss, max<uint64_t>(2 * _mss, 4380));
+}
+
+double CongestionController::pacing_rate(const double srtt) const {
+    // a window per RTT, with headroom for the window to grow: double it in slow start, where the window
+    // doubles each RTT, and 20% more after (Linux's ratios)
+    return (in_slow_start() ? 2.0 : 1.2) * cwnd() / srtt;
+}
+
+// Reno
+
+RenoController::RenoController(const size_t mss) : CongestionController(mss), _cwnd(_initial_window()) {}
+
+void RenoController::on_ack(const AckEvent &ack) {
+    // the window stays at ssthresh until recovery is over
+    if (ack.in_recovery) {
+        return;
+    }
+
+    // slow start: one segment per acknowledgment, i.e. doubling every round trip
+    if (_cwnd < _ssthresh) {
+        _cwnd += min<uint64_t>(ack.bytes_acked, _mss);
+        return;
+    }
+
+    // congestion avoidance: one segment per window's worth of acknowledgments
+    _acked_in_window += ack.bytes_acked;
+    if (_acked_in_window >= _cwnd) {
+        _acked_in_window -= _cwnd;
+        _cwnd += _mss;
+    }
+}
+
+void RenoController::_reduce(const uint64_t bytes_in_flight) {
+    _ssthresh = max<uint64_t>(bytes_in_flight / 2, 2 * _mss);
+    _acked_in_window = 0;
+}
+
+void RenoController::on_loss(const uint64_t /* now */, const uint64_t bytes_in_flight) {
+    _reduce(bytes_in_flight);
+    _cwnd = _ssthresh;
+}
+
+void RenoController::on_rto(const uint64_t /* now */, const uint64_t bytes_in_flight) {
+    _reduce(bytes_in_flight);
+    _cwnd = _mss;
+}
+
+// CUBIC
+
+CubicController::CubicController(const size_t mss) : CongestionController(mss), _cwnd(_initial_window()) {}
+
+void CubicController::on_ack(const AckEvent &ack) {
+    if (ack.rtt.has_value()) {
+        _min_rtt = min(_min_rtt.value_or(UINT64_MAX), ack.rtt.value());
+    }
+    if (ack.in_recovery) {
+        return;
+    }
+
+    if (_cwnd < _ssthresh) {
+        _cwnd += min<double>(ack.bytes_acked, _mss);
+        return;
+    }
+
+    if (not _epoch_start.has_value()) {
+        _epoch_start = ack.now;
+        if (_cwnd < _w_max) {
+            _k = cbrt((_w_max - _cwnd) / _mss / C);
+        } else {
+            _k = 0;
+            _w_max = _cwnd;
+        }
+        _w_est = _cwnd;
+    }
+
+    // where the cubic curve will be one RTT from now, kept between the current window and 1.5x it
+    const double t = double(ack.now - _epoch_start.value() + _min_rtt.value_or(0)) / 1000;
+    const double w_cubic = _w_max + C * pow(t - _k, 3) * _mss;
+    const double target = min(max(w_cubic, _cwnd), 1.5 * _cwnd);
+
+    // never grow more slowly than Reno would
+    _w_est += 3 * (1 - BETA) / (1 + BETA) * ack.bytes_acked * _mss / _cwnd;
+    if (_w_est > target) {
+        _cwnd = max(_cwnd, _w_est);
+    } else {
+        _cwnd += (target - _cwnd) / _cwnd * ack.bytes_acked;
+    }
+}
+
+void CubicController::_reduce() {
+    // fast convergence: if the window is smaller than last time, another flow needs the bandwidth
+    _w_max = _cwnd < _w_max ? _cwnd * (1 + BETA) / 2 : _cwnd;
+    _ssthresh = max(_cwnd * BETA, 2.0 * _mss);
+    _epoch_start.reset();
+}
+
+void CubicController::on_loss(const uint64_t /* now */, const uint64_t /* bytes_in_flight */) {
+    _reduce();
+    _cwnd = _ssthresh;
+}
+
+void CubicController::on_rto(const uint64_t /* now */, const uint64_t /* bytes_in_flight */) {
+    _reduce();
+    _cwnd = _mss;
+}
+
+// BBR
+
+BBRController::BBRController(const size_t mss) : CongestionController(mss), _cwnd(_initial_window()) {}
+
+double BBRController::_pacing_gain() const {
+    switch (_mode) {
+        case Mode::Startup:
+            return STARTUP_GAIN;
+        case Mode::Drain:
+            // pacing is what drains the queue startup built: below the bottleneck rate, by startup's gain
+            return 1 / STARTUP_GAIN;
+        default:
+            return PROBE_GAINS[_cycle_index];
+    }
+}
+
+double BBRController::_cwnd_gain() const {
+    // drain keeps startup's window, so that the lower pacing rate, not the window, is what limits sending;
+    // the probing cycle varies only the pacing rate
+    return _mode == Mode::ProbeBW ? PROBE_BW_CWND_GAIN : STARTUP_GAIN;
+}
+
+double BBRController::pacing_rate(const double srtt) const {
+    if (_btl_bw == 0) {
+        return CongestionController::pacing_rate(srtt);
+    }
+    return _pacing_gain() * _btl_bw;
+}
+
+uint64_t BBRController::_bdp() const {
+    return max<uint64_t>(4 * _mss, static_cast<uint64_t>(_btl_bw * _min_rtt.value_or(0)));
+}
+
+void BBRController::on_ack(const AckEvent &ack) {
+    bool round_start = false;
+    if (ack.delivered_at_send >= _next_round_delivered) {
+        _next_round_delivered = ack.delivered;
+        ++_round;
+        round_start = true;
+    }
+
+    // samples from retransmitted segments are ambiguous, so only use the others
+    if (ack.rtt.has_value()) {
+        const uint64_t rtt = max<uint64_t>(ack.rtt.value(), 1);
+        if (not _min_rtt.has_value() or rtt <= _min_rtt.value() or ack.now - _min_rtt_stamp > MIN_RTT_WINDOW) {
+            _min_rtt = rtt;
+            _min_rtt_stamp = ack.now;
+        }
+
+        // delivery rate over the time the acknowledged segment was in flight
+        const double bw = double(ack.delivered - ack.delivered_at_send) / max<uint64_t>(ack.now - ack.sent_at, 1);
+        while (not _bw_samples.empty() and _bw_samples.back().second <= bw) {
+            _bw_samples.pop_back();
+        }
+        _bw_samples.emplace_back(_round, bw);
+        while (_bw_samples.front().first + BW_WINDOW_ROUNDS <= _round) {
+            _bw_samples.pop_front();
+        }
+        _btl_bw = _bw_samples.front().second;
+    }
+
+    if (_mode == Mode::Startup and round_start) {
+        if (_btl_bw >= _full_bw * 1.25) {
+            _full_bw = _btl_bw;
+            _full_bw_rounds = 0;
+        } else if (++_full_bw_rounds >= 3) {
+            _mode = Mode::Drain;
+        }
+    }
+    if (_mode == Mode::Drain and ack.bytes_in_flight <= _bdp()) {
+        _mode = Mode::ProbeBW;
+        _cycle_index = 0;
+        _cycle_stamp = ack.now;
+    }
+    if (_mode == Mode::ProbeBW and ack.now - _cycle_stamp >= _min_rtt.value_or(0)) {
+        _cycle_index = (_cycle_index + 1) % (sizeof(PROBE_GAINS) / sizeof(PROBE_GAINS[0]));
+        _cycle_stamp = ack.now;
+    }
+
+    const uint64_t target = max<uint64_t>(4 * _mss, static_cast<uint64_t>(_cwnd_gain() * _bdp()));
+    if (_btl_bw == 0 or not _min_rtt.has_value()) {
+        // no model of the path yet
+        _cwnd += ack.bytes_acked;
+    } else if (_mode == Mode::Startup) {
+        // the window only grows during startup, however far the first estimates of the path fall short
+        _cwnd = max(_cwnd, min(_cwnd + ack.bytes_acked, target));
+    } else {
+        _cwnd = target;
+    }
+}
+
+void BBRController::on_loss(const uint64_t /* now */, const uint64_t /* bytes_in_flight */) {
+    // loss is not taken as a sign of congestion: the window follows the path model
+}
+
+void BBRController::on_rto(const uint64_t /* now */, const uint64_t /* bytes_in_flight */) {
+    // start over from one segment; the next acknowledgment restores the window from the model
+    _cwnd = _mss;
+}
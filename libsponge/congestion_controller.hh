@@ -0,0 +1,187 @@
+#ifndef SPONGE_LIBSPONGE_CONGESTION_CONTROLLER_HH
+#define SPONGE_LIBSPONGE_CONGESTION_CONTROLLER_HH
+
+#include "tcp_config.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+
+//! \brief What the TCPSender learned from an acknowledgment that acknowledged new data
+struct AckEvent {
+    uint64_t now{};              //!< Current time, in ms since the sender was created
+    uint64_t bytes_acked{};      //!< Sequence space newly acknowledged
+    uint64_t bytes_in_flight{};  //!< Sequence space still outstanding afterwards
+    uint64_t delivered{};        //!< Total sequence space acknowledged so far (including this ACK)
+    bool in_recovery{};          //!< The sender is still repairing losses found by duplicate ACKs
+
+    //! \name The newest segment this ACK acknowledged
+    //!@{
+    uint64_t sent_at{};            //!< When it was sent
+    uint64_t delivered_at_send{};  //!< `delivered` when it was sent
+    //! Its round-trip time, unless the ACK covers a retransmitted segment (and so is ambiguous; see Karn's algorithm)
+    std::optional<uint64_t> rtt{};
+    //!@}
+};
+
+//! \brief The congestion-control half of a TCPSender
+
+//! The TCPSender reports what happens to its segments through the on_*() hooks, and never has more
+//! than min(cwnd(), receiver's window) bytes of sequence space in flight.
+class CongestionController {
+  protected:
+    size_t _mss;  //!< Maximum segment size, in bytes
+
+    //! The window before anything is known about the path (RFC 5681 section 3.1)
+    uint64_t _initial_window() const;
+
+  public:
+    //! \param[in] mss the largest payload the sender puts in one segment
+    explicit CongestionController(const size_t mss) : _mss(mss) {}
+    virtual ~CongestionController() = default;
+
+    //! \returns a controller implementing `algorithm`, or nullptr for CongestionControl::None
+    static std::unique_ptr<CongestionController> make(const TCPConfig::CongestionControl algorithm, const size_t mss);
+
+    //! The sender's segments changed size (after the peer's MSS option, or a path MTU probe)
+    void set_mss(const size_t mss) { _mss = mss; }
+
+    //! The congestion window: how much sequence space may be in flight
+    virtual uint64_t cwnd() const = 0;
+
+    //! Whether the window is still growing quickly to find the path's capacity
+    virtual bool in_slow_start() const { return false; }
+
+    //! How fast a pacing sender should send, in bytes per ms, given the smoothed RTT in ms
+    virtual double pacing_rate(const double srtt) const;
+
+    //! \name Hooks called by the TCPSender
+    //!@{
+
+    //! A new segment (not a retransmission) occupying `bytes` of sequence space was sent
+    virtual void on_send(const uint64_t /* now */, const uint64_t /* bytes */, const uint64_t /* bytes_in_flight */) {}
+
+    //! An acknowledgment acknowledged new data
+    virtual void on_ack(const AckEvent &ack) = 0;
+
+    //! A segment was inferred lost from duplicate acknowledgments, and is being fast-retransmitted
+    virtual void on_loss(const uint64_t now, const uint64_t bytes_in_flight) = 0;
+
+    //! The retransmission timer expired
+    virtual void on_rto(const uint64_t now, const uint64_t bytes_in_flight) = 0;
+    //!@}
+};
+
+//! \brief Slow start and additive-increase/multiplicative-decrease congestion avoidance (RFC 5681)
+class RenoController : public CongestionController {
+  protected:
+    uint64_t _cwnd;
+    uint64_t _ssthresh{UINT64_MAX};
+    uint64_t _acked_in_window{};  //!< Bytes acknowledged since the window last grew in congestion avoidance
+
+    //! Halve the window in response to congestion (but no lower than two segments)
+    void _reduce(const uint64_t bytes_in_flight);
+
+  public:
+    explicit RenoController(const size_t mss);
+
+    uint64_t cwnd() const override { return _cwnd; }
+    uint64_t ssthresh() const { return _ssthresh; }
+    bool in_slow_start() const override { return _cwnd < _ssthresh; }
+
+    void on_ack(const AckEvent &ack) override;
+    void on_loss(const uint64_t now, const uint64_t bytes_in_flight) override;
+    void on_rto(const uint64_t now, const uint64_t bytes_in_flight) override;
+};
+
+//! \brief Window growth that is a cubic function of the time since the last congestion event (RFC 8312)
+class CubicController : public CongestionController {
+  private:
+    static constexpr double C = 0.4;     //!< Scaling constant, in segments per second cubed
+    static constexpr double BETA = 0.7;  //!< Multiplicative decrease factor
+
+    double _cwnd;
+    double _ssthresh{1e18};
+    double _w_max{};                         //!< Window before the last reduction, in bytes
+    std::optional<uint64_t> _epoch_start{};  //!< Start of the current congestion-avoidance epoch
+    double _k{};                             //!< Seconds from the epoch start until the window reaches `_w_max`
+    double _w_est{};                         //!< What Reno's window would be ("TCP-friendly region")
+    std::optional<uint64_t> _min_rtt{};      //!< Smallest RTT seen, in ms
+
+    //! Reduce the window after a congestion event
+    void _reduce();
+
+  public:
+    explicit CubicController(const size_t mss);
+
+    uint64_t cwnd() const override { return static_cast<uint64_t>(_cwnd); }
+    bool in_slow_start() const override { return _cwnd < _ssthresh; }
+
+    void on_ack(const AckEvent &ack) override;
+    void on_loss(const uint64_t now, const uint64_t bytes_in_flight) override;
+    void on_rto(const uint64_t now, const uint64_t bytes_in_flight) override;
+};
+
+//! \brief A BBR-style controller that sizes the window from a model of the path, not from losses
+
+//! Delivery-rate samples feed a windowed-max estimate of the bottleneck bandwidth, and RTT samples
+//! a windowed-min estimate of the propagation delay. The window is a multiple of their product (the
+//! bandwidth-delay product): large during startup, to find the bandwidth quickly, then twice it, while
+//! the pacing rate cycles slightly above and below the bandwidth to probe for more while draining any
+//! queue it built.
+class BBRController : public CongestionController {
+  public:
+    enum class Mode { Startup, Drain, ProbeBW };
+
+  private:
+    static constexpr double STARTUP_GAIN = 2.885;  //!< 2/ln(2): enough to double the delivery rate each round
+    static constexpr unsigned BW_WINDOW_ROUNDS = 10;  //!< Rounds over which the bandwidth estimate is a max
+    static constexpr uint64_t MIN_RTT_WINDOW = 10000;  //!< ms over which the RTT estimate is a min
+    static constexpr double PROBE_GAINS[8] = {1.25, 0.75, 1, 1, 1, 1, 1, 1};  //!< Pacing gains of the cycle
+    static constexpr double PROBE_BW_CWND_GAIN = 2;  //!< Room for delayed or stretched ACKs after startup
+
+    Mode _mode{Mode::Startup};
+    uint64_t _cwnd;
+
+    //! Delivery-rate samples (bytes per ms) by round, for the windowed max
+    std::deque<std::pair<uint64_t, double>> _bw_samples{};
+    double _btl_bw{};
+
+    std::optional<uint64_t> _min_rtt{};
+    uint64_t _min_rtt_stamp{};
+
+    //! Round-trip counting: a round ends when a segment sent after it began is acknowledged
+    uint64_t _round{};
+    uint64_t _next_round_delivered{};
+
+    //! Startup ends once the bandwidth estimate stops growing by 25% for three rounds
+    double _full_bw{};
+    unsigned _full_bw_rounds{};
+
+    unsigned _cycle_index{};
+    uint64_t _cycle_stamp{};
+
+    double _pacing_gain() const;
+    double _cwnd_gain() const;
+    uint64_t _bdp() const;
+
+  public:
+    explicit BBRController(const size_t mss);
+
+    uint64_t cwnd() const override { return _cwnd; }
+    bool in_slow_start() const override { return _mode == Mode::Startup; }
+    double pacing_rate(const double srtt) const override;
+    Mode mode() const { return _mode; }
+
+    //! Estimated bottleneck bandwidth, in bytes per ms
+    double btl_bw() const { return _btl_bw; }
+
+    void on_ack(const AckEvent &ack) override;
+    void on_loss(const uint64_t now, const uint64_t bytes_in_flight) override;
+    void on_rto(const uint64_t now, const uint64_t bytes_in_flight) override;
+};
+
+#endif  // SPONGE_LIBSPONGE_CONGESTION_CONTROLLER_HH
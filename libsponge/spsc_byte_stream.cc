@@ -0,0 +1,135 @@
+#include "spsc_byte_stream.hh"
+
+#include "util.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Lock-free single-producer/single-consumer byte stream.
+
+// The writer only ever stores `_write_total` and the reader only ever stores `_read_total`;
+// both counters only grow, so `_write_total - _read_total` is the number of buffered bytes
+// and the ring index of a counter is its value modulo the capacity.
+
+// Wakeups use the same "store mine, then load yours" pattern on both sides (with sequentially
+// consistent ordering). A side about to block first sets its "sleeping" flag and then loads the
+// other side's counter; the other side publishes its counter and then loads the flag. Either the
+// sleeper sees the new counter and does not block, or the other side sees the flag and signals
+// the eventfd. While neither side is asleep, no eventfd is touched.
+
+using namespace std;
+
+SPSCByteStream::SPSCByteStream(const size_t capacity)
+    : _buffer(capacity)
+    , _capacity(capacity)
+    , _data_event(SystemCall("eventfd", eventfd(0, EFD_CLOEXEC)))
+    , _space_event(SystemCall("eventfd", eventfd(0, EFD_CLOEXEC))) {}
+
+void SPSCByteStream::_signal(FileDescriptor &event) {
+    const uint64_t one = 1;
+    SystemCall("write", ::write(event.fd_num(), &one, sizeof(one)));
+}
+
+void SPSCByteStream::_wait(FileDescriptor &event) {
+    uint64_t count;
+    SystemCall("read", ::read(event.fd_num(), &count, sizeof(count)));
+}
+
+size_t SPSCByteStream::write(const char *data, const size_t len) {
+    const uint64_t write_total = _write_total.load(memory_order_relaxed);
+    if (write_total - _writer_read_total + len > _capacity) {
+        _writer_read_total = _read_total.load(memory_order_acquire);
+    }
+    const size_t write_len = min(len, _capacity - (write_total - _writer_read_total));
+    if (write_len == 0) {
+        return 0;
+    }
+
+    const size_t tail = write_total % _capacity;
+    const size_t first = min(write_len, _capacity - tail);
+    memcpy(_buffer.data() + tail, data, first);
+    memcpy(_buffer.data(), data + first, write_len - first);
+
+    _write_total.store(write_total + write_len, memory_order_seq_cst);
+    if (_reader_sleeping.load(memory_order_seq_cst)) {
+        _signal(_data_event);
+    }
+    return write_len;
+}
+
+size_t SPSCByteStream::remaining_capacity() const {
+    return _capacity - (_write_total.load(memory_order_relaxed) - _read_total.load(memory_order_acquire));
+}
+
+void SPSCByteStream::end_input() {
+    _has_ended.store(true, memory_order_seq_cst);
+    if (_reader_sleeping.load(memory_order_seq_cst)) {
+        _signal(_data_event);
+    }
+}
+
+void SPSCByteStream::wait_until_writable() {
+    while (true) {
+        _writer_sleeping.store(true, memory_order_seq_cst);
+        if (_write_total.load(memory_order_relaxed) - _read_total.load(memory_order_seq_cst) != _capacity) {
+            break;
+        }
+        _wait(_space_event);
+    }
+    _writer_sleeping.store(false, memory_order_relaxed);
+}
+
+//! \param[out] dest memory with room for at least `len` bytes
+//! \param[in] len bytes will be popped and copied into `dest`
+size_t SPSCByteStream::read_into(char *dest, const size_t len) {
+    const uint64_t read_total = _read_total.load(memory_order_relaxed);
+    if (_reader_write_total - read_total < len) {
+        _reader_write_total = _write_total.load(memory_order_acquire);
+    }
+    const size_t read_len = min(len, size_t(_reader_write_total - read_total));
+    if (read_len == 0) {
+        return 0;
+    }
+
+    const size_t head = read_total % _capacity;
+    const size_t first = min(read_len, _capacity - head);
+    memcpy(dest, _buffer.data() + head, first);
+    memcpy(dest + first, _buffer.data(), read_len - first);
+
+    _read_total.store(read_total + read_len, memory_order_seq_cst);
+    if (_writer_sleeping.load(memory_order_seq_cst)) {
+        _signal(_space_event);
+    }
+    return read_len;
+}
+
+//! \param[in] len bytes will be popped and returned
+//! \returns a string
+string SPSCByteStream::read(const size_t len) {
+    string ret(min(len, buffer_size()), 0);
+    ret.resize(read_into(ret.data(), ret.size()));
+    return ret;
+}
+
+size_t SPSCByteStream::buffer_size() const {
+    return _write_total.load(memory_order_acquire) - _read_total.load(memory_order_relaxed);
+}
+
+bool SPSCByteStream::eof() const {
+    // check for the ending first: once it is visible, so are all the bytes written before it
+    return _has_ended.load(memory_order_acquire) and buffer_size() == 0;
+}
+
+void SPSCByteStream::wait_until_readable() {
+    while (true) {
+        _reader_sleeping.store(true, memory_order_seq_cst);
+        if (_has_ended.load(memory_order_seq_cst) or
+            _read_total.load(memory_order_relaxed) != _write_total.load(memory_order_seq_cst)) {
+            break;
+        }
+        _wait(_data_event);
+    }
+    _reader_sleeping.store(false, memory_order_relaxed);
+}
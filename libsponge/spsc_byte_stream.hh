@@ -0,0 +1,113 @@
+#ifndef SPONGE_LIBSPONGE_SPSC_BYTE_STREAM_HH
+#define SPONGE_LIBSPONGE_SPSC_BYTE_STREAM_HH
+
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! \brief An in-order byte stream that one thread writes and another thread reads, without locks.
+
+//! Like ByteStream, the bytes live in a ring buffer of `capacity` bytes, but the read and write
+//! positions are atomics so that a single writer thread and a single reader thread can use the
+//! stream concurrently. The writer-owned and reader-owned state sit on separate cache lines, and so
+//! does each side's sleeping flag, which the other side checks on every call.
+//!
+//! Each side can block on an eventfd, which the other side signals only if the blocked side has
+//! said it is asleep, so neither side makes a system call while the other keeps up.
+class SPSCByteStream {
+  private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    std::vector<char> _buffer;
+    size_t _capacity;
+
+    //! Signalled by the writer, when the reader is asleep, after writing or ending the input
+    FileDescriptor _data_event;
+    //! Signalled by the reader, when the writer is asleep, after reading
+    FileDescriptor _space_event;
+
+    //! Total bytes written (owned by the writer)
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> _write_total{0};
+    std::atomic<bool> _has_ended{false};
+    //! The writer's last look at `_read_total` (writer-only)
+    uint64_t _writer_read_total{0};
+    //! Set by the writer while it is waiting on `_space_event` (on a line of its own, since the reader
+    //! checks it on every read, and would otherwise share the line `_write_total` moves on every write)
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> _writer_sleeping{false};
+
+    //! Total bytes read (owned by the reader)
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> _read_total{0};
+    //! The reader's last look at `_write_total` (reader-only)
+    uint64_t _reader_write_total{0};
+    //! Set by the reader while it is waiting on `_data_event` (on a line of its own, likewise)
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> _reader_sleeping{false};
+
+    //! Wake up a thread waiting on `event`
+    static void _signal(FileDescriptor &event);
+
+    //! Sleep until `event` has been signalled (and clear it)
+    static void _wait(FileDescriptor &event);
+
+  public:
+    //! Construct a stream with room for `capacity` bytes.
+    SPSCByteStream(const size_t capacity);
+
+    //! \name "Input" interface for the writer thread
+    //!@{
+
+    //! Write up to `len` bytes from `data` into the stream, as many as will fit
+    //! \returns the number of bytes accepted into the stream
+    size_t write(const char *data, const size_t len);
+
+    //! Write a string of bytes into the stream, as many as will fit
+    //! \returns the number of bytes accepted into the stream
+    size_t write(const std::string &data) { return write(data.data(), data.size()); }
+
+    //! \returns the number of additional bytes that the stream has space for
+    size_t remaining_capacity() const;
+
+    //! Signal that the byte stream has reached its ending
+    void end_input();
+
+    //! Block until the stream has space for at least one byte
+    void wait_until_writable();
+    //!@}
+
+    //! \name "Output" interface for the reader thread
+    //!@{
+
+    //! Read (i.e., copy and then pop) up to `len` bytes of the stream into caller-owned memory
+    //! \returns the number of bytes read
+    size_t read_into(char *dest, const size_t len);
+
+    //! Read (i.e., copy and then pop) up to `len` bytes of the stream
+    std::string read(const size_t len);
+
+    //! \returns the maximum amount that can currently be read from the stream
+    size_t buffer_size() const;
+
+    //! \returns `true` if the output has reached the ending
+    bool eof() const;
+
+    //! Block until the stream has at least one byte to read or has reached its ending
+    void wait_until_readable();
+    //!@}
+
+    //! \name General accounting
+    //!@{
+
+    //! \returns `true` if the stream input has ended
+    bool input_ended() const { return _has_ended.load(std::memory_order_acquire); }
+
+    //! Total number of bytes written
+    size_t bytes_written() const { return _write_total.load(std::memory_order_acquire); }
+
+    //! Total number of bytes popped
+    size_t bytes_read() const { return _read_total.load(std::memory_order_acquire); }
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_SPSC_BYTE_STREAM_HH
@@ -2,80 +2,289 @@
 
 #include "iostream"
 
-// Dummy implementation of a stream reassembler.
-
-// For Lab 1, please replace with a real implementation that passes the
-// automated checks run by `make check_lab1`.
-
-// You will need to add private members to the class declaration in `stream_reassembler.hh`
-
-template <typename... Targs>
-void DUMMY_CODE(Targs &&.../* unused */) {}
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
-StreamReassembler::StreamReassembler(const size_t capacity) : _output(capacity), _capacity(capacity) {}
+//! \returns the `len` bytes of `buffer` starting at `offset`, sharing its storage
+static Buffer slice(Buffer buffer, const size_t offset, const size_t len) {
+    buffer.remove_prefix(offset);
+    buffer.remove_suffix(buffer.size() - len);
+    return buffer;
+}
+
+StreamReassembler::StreamReassembler(const size_t capacity, const Engine engine, const ByteStream::Storage storage)
+    : _engine(engine)
+    , _window(engine == Engine::Bitmap ? capacity : 0)
+    , _present(engine == Engine::Bitmap ? (capacity + 63) / 64 : 0)
+    , _output(capacity, storage)
+    , _capacity(capacity) {}
 
 //! \details This function accepts a substring (aka a segment) of bytes,
 //! possibly out-of-order, from the logical stream, and assembles any newly
 //! contiguous substrings and writes them into the output stream in order.
 void StreamReassembler::push_substring(const string &data, const size_t index, const bool eof) {
-    DUMMY_CODE(data, index, eof);
+    push_substring(Buffer{string(data)}, index, eof);
+}
+
+void StreamReassembler::push_substring(string &&data, const size_t index, const bool eof) {
+    push_substring(Buffer{move(data)}, index, eof);
+}
 
+void StreamReassembler::push_substring(Buffer data, const size_t index, const bool eof) {
     if (eof) {
-        _eof_index = index + data.length();
+        _eof_index = index + data.size();
         _has_ended = true;
     }
 
-    auto first_unread = _output.bytes_read();
-    auto first_unacceptable = first_unread + _capacity;
-    // bytes that exceed the capacity are discarded
-    size_t discard_len;
-    if (index + data.length() > first_unacceptable) {
-        discard_len = index + data.length() - first_unacceptable;
-    } else {
-        discard_len = 0;
+    // bytes that were already assembled, or that exceed the capacity, are discarded
+    const size_t start = max(index, first_unassembled());
+    const size_t end = min(index + data.size(), first_unacceptable());
+
+    if (start < end and start == first_unassembled() and
+        (_engine == Engine::Bitmap or _unassembled.empty() or _unassembled.begin()->first >= end)) {
+        // fast path: in-order bytes go straight to the output
+        ++_fast_path_hits;
+        _output.write(slice(move(data), start - index, end - start));
+        if (_engine == Engine::Bitmap and _unassembled_bytes > 0) {
+            _forget_bitmap(start, end);
+        }
+    } else if (start < end) {
+        ++_slow_path_hits;
+        if (_engine == Engine::Bitmap) {
+            _store_bitmap(data, index, start, end);
+        } else {
+            _store(data, index, start, end);
+        }
     }
 
-    auto first_unassembled = _output.bytes_written();
-    // bytes that overlap are discarded
-    size_t discard_prefix;
-    if (first_unassembled > index) {
-        discard_prefix = first_unassembled - index;
+    if (_engine == Engine::Bitmap) {
+        _assemble_bitmap();
     } else {
-        discard_prefix = 0;
+        _assemble();
+    }
+
+    if (_has_ended && _output.bytes_written() == _eof_index) {
+        _output.end_input();
     }
+}
 
-    for (size_t i = discard_prefix; i < data.length() - discard_len; i++) {
-        // bytes that overlap are discarded
-        if (!_buffer.count(index + i)) {
-            _buffer[index + i] = data[i];
+void StreamReassembler::_store(const Buffer &data, const size_t index, size_t start, const size_t end) {
+    // bytes that overlap a stored substring are discarded, so only the gaps between them are stored
+    auto it = _unassembled.upper_bound(start);
+    if (it != _unassembled.begin()) {
+        const auto prev = std::prev(it);
+        start = max(start, prev->first + prev->second.size());
+    }
+    while (start < end) {
+        const size_t gap_end = it == _unassembled.end() ? end : min(end, it->first);
+        if (gap_end > start) {
+            // a stored slice may wait a long time for the bytes before it, so it does not hold on to
+            // storage much larger than itself (the copy counts as one made for the output)
+            Buffer stored = slice(data, start - index, gap_end - start);
+            if (stored.compact()) {
+                _output.count_copied(stored.size());
+            }
+            _unassembled.emplace_hint(it, start, move(stored));
+            _unassembled_bytes += gap_end - start;
         }
+        if (it == _unassembled.end()) {
+            break;
+        }
+        start = max(start, it->first + it->second.size());
+        ++it;
     }
-    string assemble_str{};
-    for (size_t i = first_unassembled; i < first_unacceptable; i++) {
-        if (_buffer.count(i)) {
-            assemble_str += _buffer[i];
-        } else {
+}
+
+//! \details Hands the run of stored slices that starts at first_unassembled() to the output.
+//! The run always fits: stored bytes lie below first_unacceptable().
+void StreamReassembler::_assemble() {
+    auto it = _unassembled.begin();
+    while (it != _unassembled.end() and it->first == first_unassembled()) {
+        _unassembled_bytes -= it->second.size();
+        _output.write(move(it->second));
+        it = _unassembled.erase(it);
+    }
+}
+
+void StreamReassembler::_store_bitmap(const Buffer &data, const size_t index, size_t start, const size_t end) {
+    // [start, end) lies within the window, so it wraps around the ring at most once
+    while (start < end) {
+        const size_t pos = start % _capacity;
+        const size_t len = min(end - start, _capacity - pos);
+        memcpy(_window.data() + pos, data.str().data() + (start - index), len);
+        _unassembled_bytes += _set_present(pos, len);
+        start += len;
+    }
+}
+
+//! \details Finds the run of present bytes at first_unassembled() a word of the bitmap at a time,
+//! and writes it to the output straight from the window (in two writes if it wraps around the ring).
+void StreamReassembler::_assemble_bitmap() {
+    if (_unassembled_bytes == 0) {
+        return;
+    }
+    const size_t pos = first_unassembled() % _capacity;
+    const size_t first_len = _present_run(pos, _capacity - pos);
+    const size_t second_len = first_len == _capacity - pos ? _present_run(0, pos) : 0;
+    if (first_len == 0) {
+        return;
+    }
+
+    _output.write(_window.data() + pos, first_len);
+    _clear_present(pos, first_len);
+    if (second_len > 0) {
+        _output.write(_window.data(), second_len);
+        _clear_present(0, second_len);
+    }
+    _unassembled_bytes -= first_len + second_len;
+}
+
+size_t StreamReassembler::_set_present(size_t pos, const size_t len) {
+    size_t newly_set = 0;
+    const size_t end = pos + len;
+    while (pos < end) {
+        const size_t bit = pos % 64;
+        const size_t n = min(64 - bit, end - pos);
+        const uint64_t mask = (n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1) << bit;
+        uint64_t &word = _present[pos / 64];
+        newly_set += __builtin_popcountll(mask & ~word);
+        word |= mask;
+        pos += n;
+    }
+    return newly_set;
+}
+
+size_t StreamReassembler::_clear_present(size_t pos, const size_t len) {
+    size_t cleared = 0;
+    const size_t end = pos + len;
+    while (pos < end) {
+        const size_t bit = pos % 64;
+        const size_t n = min(64 - bit, end - pos);
+        const uint64_t mask = (n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1) << bit;
+        uint64_t &word = _present[pos / 64];
+        cleared += __builtin_popcountll(mask & word);
+        word &= ~mask;
+        pos += n;
+    }
+    return cleared;
+}
+
+void StreamReassembler::_forget_bitmap(size_t start, const size_t end) {
+    while (start < end) {
+        const size_t pos = start % _capacity;
+        const size_t len = min(end - start, _capacity - pos);
+        _unassembled_bytes -= _clear_present(pos, len);
+        start += len;
+    }
+}
+
+size_t StreamReassembler::_present_run(const size_t pos, const size_t max_len) const {
+    size_t run = 0;
+    while (run < max_len) {
+        const size_t bit = (pos + run) % 64;
+        // the first hole at or after `bit` (bits shifted in from the top count as present)
+        const uint64_t holes = ~_present[(pos + run) / 64] >> bit;
+        if (holes != 0) {
+            run += __builtin_ctzll(holes);
             break;
         }
+        run += 64 - bit;
     }
+    return min(run, max_len);
+}
 
-    if (assemble_str.length() != 0) {
-        auto write_len = _output.write(assemble_str);
-        for (size_t i = first_unassembled; i < first_unassembled + write_len; i++) {
-            _buffer.erase(i);
+size_t StreamReassembler::_absent_run(const size_t pos, const size_t max_len) const {
+    size_t run = 0;
+    while (run < max_len) {
+        const size_t bit = (pos + run) % 64;
+        // the first present byte at or after `bit` (bits shifted in from the top count as absent)
+        const uint64_t present = _present[(pos + run) / 64] >> bit;
+        if (present != 0) {
+            run += __builtin_ctzll(present);
+            break;
         }
+        run += 64 - bit;
     }
+    return min(run, max_len);
+}
 
-    if (_has_ended && _output.bytes_written() == _eof_index) {
-        _output.end_input();
+size_t StreamReassembler::_bitmap_run(size_t index, const bool present) const {
+    const size_t start = index;
+    // the window wraps around the ring at most once
+    while (index < first_unacceptable()) {
+        const size_t pos = index % _capacity;
+        const size_t max_len = min(first_unacceptable() - index, _capacity - pos);
+        const size_t len = present ? _present_run(pos, max_len) : _absent_run(pos, max_len);
+        index += len;
+        if (len < max_len) {
+            break;
+        }
+    }
+    return index - start;
+}
+
+optional<pair<size_t, size_t>> StreamReassembler::unassembled_run(const size_t index) const {
+    if (_unassembled_bytes == 0) {
+        return {};
+    }
+
+    if (_engine == Engine::Bitmap) {
+        const size_t first = max(index, first_unassembled());
+        const size_t gap = _bitmap_run(first, false);
+        if (first + gap >= first_unacceptable()) {
+            return {};
+        }
+        return {{first + gap, first + gap + _bitmap_run(first + gap, true)}};
+    }
+
+    // stored substrings never overlap, but they can be adjacent
+    auto it = _unassembled.lower_bound(index);
+    if (it == _unassembled.end()) {
+        return {};
+    }
+    const size_t first = it->first;
+    size_t last = first;
+    for (; it != _unassembled.end() and it->first == last; ++it) {
+        last += it->second.size();
+    }
+    return {{first, last}};
+}
+
+void StreamReassembler::set_capacity(const size_t capacity) {
+    vector<pair<size_t, size_t>> runs;
+    for (auto run = unassembled_run(first_unassembled()); run.has_value(); run = unassembled_run(run.value().second)) {
+        runs.push_back(run.value());
+    }
+    const size_t needed = (runs.empty() ? first_unassembled() : runs.back().second) - first_unread();
+    const size_t old_capacity = _capacity;
+    _capacity = max(capacity, needed);
+    _output.set_capacity(_capacity);
+
+    if (_engine != Engine::Bitmap) {
+        return;
+    }
+    // the stored bytes move to where the stream index maps in the new ring
+    vector<char> old_window = exchange(_window, vector<char>(_capacity));
+    _present.assign((_capacity + 63) / 64, 0);
+    for (const auto &[first, last] : runs) {
+        for (size_t index = first; index < last;) {
+            const size_t from = index % old_capacity;
+            const size_t to = index % _capacity;
+            const size_t len = min({last - index, old_capacity - from, _capacity - to});
+            memcpy(_window.data() + to, old_window.data() + from, len);
+            _set_present(to, len);
+            index += len;
+        }
     }
 }
 
-size_t StreamReassembler::unassembled_bytes() const { return _buffer.size(); }
+size_t StreamReassembler::unassembled_bytes() const { return _unassembled_bytes; }
 
-bool StreamReassembler::empty() const { return _buffer.empty(); }
+bool StreamReassembler::empty() const { return _unassembled_bytes == 0; }
 
 size_t StreamReassembler::first_unread() const { return _output.bytes_read(); }
 
@@ -4,25 +4,80 @@
 #include "byte_stream.hh"
 
 #include <cstdint>
-#include <unordered_map>
+#include <map>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 //! \brief A class that assembles a series of excerpts from a byte stream (possibly out of order,
 //! possibly overlapping) into an in-order byte stream.
 class StreamReassembler {
+  public:
+    //! How the bytes that are not yet assembled are stored
+    enum class Engine {
+        Map,    //!< Keep each received substring in an ordered map keyed by stream index
+        Bitmap  //!< Copy received bytes into a preallocated window, tracking which are present in a bitmap
+    };
+
   private:
-    // Your code here -- add private members as necessary.
-    std::unordered_map<size_t, char> _buffer{};
+    Engine _engine;
+
+    //! Engine::Map: substrings waiting for earlier bytes, keyed by stream index; they never overlap
+    //! \note These are slices of the pushed Buffers (e.g. TCP segment payloads), copied only when they cover
+    //! little of their storage (see Buffer::compact())
+    std::map<size_t, Buffer> _unassembled{};
+
+    //! Engine::Bitmap: ring of `_capacity` bytes; the byte at stream index i lives at i % `_capacity`
+    std::vector<char> _window{};
+    //! Engine::Bitmap: one bit per byte of `_window`, set if that byte has been received
+    std::vector<uint64_t> _present{};
+
+    size_t _unassembled_bytes{};  //!< Number of bytes received but not yet assembled
     size_t _eof_index{};
     bool _has_ended{};
     ByteStream _output;  //!< The reassembled in-order byte stream
     size_t _capacity{};    //!< The maximum number of bytes
+    size_t _fast_path_hits{};  //!< Substrings written straight to the output
+    size_t _slow_path_hits{};  //!< Substrings that had to be stored first
+
+    //! Store the bytes of `data` (which starts at `index`) that lie in [start, end)
+    void _store(const Buffer &data, const size_t index, size_t start, const size_t end);
+    void _store_bitmap(const Buffer &data, const size_t index, size_t start, const size_t end);
+
+    //! Write the stored bytes that have become contiguous with the output
+    void _assemble();
+    void _assemble_bitmap();
+
+    //! Set the bits for `_window[pos, pos + len)`, which must not wrap
+    //! \returns the number of those bits that were not already set
+    size_t _set_present(size_t pos, const size_t len);
+
+    //! Clear the bits for `_window[pos, pos + len)`, which must not wrap
+    //! \returns the number of those bits that were set
+    size_t _clear_present(size_t pos, const size_t len);
+
+    //! Forget any stored bytes of the stream in [start, end), which have been assembled another way
+    void _forget_bitmap(size_t start, const size_t end);
+
+    //! \returns the number of consecutive set bits starting at `pos`, up to `max_len`
+    size_t _present_run(const size_t pos, const size_t max_len) const;
+
+    //! \returns the number of consecutive clear bits starting at `pos`, up to `max_len`
+    size_t _absent_run(const size_t pos, const size_t max_len) const;
+
+    //! \returns the number of consecutive stream indices from `index` (up to first_unacceptable())
+    //! whose bytes are stored (if `present`) or not
+    size_t _bitmap_run(size_t index, const bool present) const;
 
   public:
     //! \brief Construct a `StreamReassembler` that will store up to `capacity` bytes.
     //! \note This capacity limits both the bytes that have been reassembled,
     //! and those that have not yet been reassembled.
-    StreamReassembler(const size_t capacity);
+    //! \param storage how the reassembled output stream stores its bytes
+    StreamReassembler(const size_t capacity,
+                      const Engine engine = Engine::Map,
+                      const ByteStream::Storage storage = ByteStream::Storage::Ring);
 
     //! \brief Receive a substring and write any newly contiguous bytes into the stream.
     //!
@@ -34,6 +89,19 @@ class StreamReassembler {
     //! \param eof the last byte of `data` will be the last byte in the entire stream
     void push_substring(const std::string &data, const uint64_t index, const bool eof);
 
+    //! \brief Receive a substring, taking ownership of it
+    void push_substring(std::string &&data, const uint64_t index, const bool eof);
+
+    //! \brief Receive a substring as a Buffer, sharing its storage
+    //! \note Out-of-order bytes are kept as slices of `data` (unless they cover little of its storage),
+    //! and in-order bytes are handed to the output stream as a slice too, so they are copied at most
+    //! once (and, if the output stream is Storage::Chunked, not at all unless stored out of order)
+    void push_substring(Buffer data, const uint64_t index, const bool eof);
+
+    //! \brief Change how many bytes the reassembler and its output stream may hold
+    //! \details The capacity never drops below what the bytes already stored need, so none are lost.
+    void set_capacity(const size_t capacity);
+
     //! \name Access the reassembled byte stream
     //!@{
     const ByteStream &stream_out() const { return _output; }
@@ -50,6 +118,22 @@ class StreamReassembler {
     //! \returns `true` if no substrings are waiting to be assembled
     bool empty() const;
 
+    //! \brief The first run of stored bytes at or after `index`, as [first, last) stream indices
+    //! \details Starting from first_unassembled() and then passing the end of each run walks the runs
+    //! in order (e.g. to report them as TCP SACK blocks).
+    //! \returns empty if no bytes are stored at or after `index`
+    std::optional<std::pair<size_t, size_t>> unassembled_run(const size_t index) const;
+
+    //! \name Counters of how push_substring() handled substrings that carried new bytes
+    //!@{
+
+    //! Substrings that began at first_unassembled() and were written straight to the output
+    size_t fast_path_hits() const { return _fast_path_hits; }
+
+    //! Substrings that left a gap (or overlapped stored bytes) and had to be stored first
+    size_t slow_path_hits() const { return _slow_path_hits; }
+    //!@}
+
     size_t first_unread() const;
     size_t first_unassembled() const;
     size_t first_unacceptable() const;
@@ -1,49 +1,264 @@
 #include "tcp_connection.hh"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <optional>
 
-// Dummy implementation of a TCP connection
+using namespace std;
 
-// For Lab 4, please replace with a real implementation that passes the
-// automated checks run by `make check`.
+//! RFC 7323 section 2.3: shifts above 14 would make windows larger than the sequence space allows
+static constexpr uint8_t MAX_WINDOW_SHIFT = 14;
 
-template <typename... Targs>
-void DUMMY_CODE(Targs &&... /* unused */) {}
+TCPConnection::TCPConnection(const TCPConfig &cfg)
+    : _cfg{cfg}
+    , _receive_window_shift([&] {
+        // with autotuning, the window may grow to the largest capacity
+        const size_t capacity =
+            cfg.recv_autotuning ? max(cfg.recv_capacity, cfg.recv_capacity_max) : cfg.recv_capacity;
+        uint8_t shift = 0;
+        while (shift < MAX_WINDOW_SHIFT and (capacity >> shift) > numeric_limits<uint16_t>::max()) {
+            ++shift;
+        }
+        return shift;
+    }()) {}
 
-using namespace std;
+size_t TCPConnection::remaining_outbound_capacity() const { return _sender.stream_in().remaining_capacity(); }
 
-size_t TCPConnection::remaining_outbound_capacity() const { return {}; }
+size_t TCPConnection::bytes_in_flight() const { return _sender.bytes_in_flight(); }
 
-size_t TCPConnection::bytes_in_flight() const { return {}; }
+size_t TCPConnection::unassembled_bytes() const { return _receiver.unassembled_bytes(); }
 
-size_t TCPConnection::unassembled_bytes() const { return {}; }
+size_t TCPConnection::time_since_last_segment_received() const { return _time_since_last_segment_received; }
 
-size_t TCPConnection::time_since_last_segment_received() const { return {}; }
+void TCPConnection::segment_received(const TCPSegment &seg) {
+    if (not _active) {
+        return;
+    }
+    _time_since_last_segment_received = 0;
 
-void TCPConnection::segment_received(const TCPSegment &seg) { DUMMY_CODE(seg); }
+    // in LISTEN, only a SYN can start the connection (and a RST is ignored)
+    const bool listening = _sender.next_seqno_absolute() == 0 and not _receiver.ackno().has_value();
+    if (listening and (not seg.header().syn or seg.header().rst)) {
+        return;
+    }
 
-bool TCPConnection::active() const { return {}; }
+    // in SYN_SENT, only a segment that acknowledges our SYN can carry a RST
+    const bool syn_sent = _sender.next_seqno_absolute() > 0 and not _receiver.ackno().has_value();
+    if (syn_sent and seg.header().ack and seg.header().ackno != _sender.next_seqno()) {
+        return;
+    }
+
+    if (seg.header().rst) {
+        if (not syn_sent or seg.header().ack) {
+            _unclean_shutdown(false);
+        }
+        return;
+    }
+
+    if (seg.header().syn) {
+        _negotiate_options(seg.header());
+    }
+
+    const optional<WrappingInt32> ackno_before = _receiver.ackno();
+    const size_t unassembled_before = _receiver.unassembled_bytes();
+    _receiver.segment_received(seg);
+    const bool in_order = ackno_before.has_value() and seg.header().seqno == ackno_before.value() and
+                          _receiver.ackno() != ackno_before and unassembled_before == 0 and
+                          _receiver.unassembled_bytes() == 0;
+    if (seg.header().ack) {
+        // SACK blocks come first, so the ACK below sees a complete scoreboard
+        if (_sack and seg.header().options.sack_block_count > 0) {
+            _sender.sack_received(seg.header().options);
+        }
+        // the window in a SYN is never scaled
+        const size_t window = seg.header().syn ? seg.header().win : size_t(seg.header().win) << _send_window_shift;
+        _sender.ack_received(seg.header().ackno, window, seg.length_in_sequence_space() == 0);
+    }
+
+    // fill_window() answers a SYN (in LISTEN) with our own SYN, and sends any data the new window allows
+    _sender.fill_window();
+
+    // a segment that occupied sequence space must be acknowledged, even if we have nothing to send (but
+    // perhaps not at once)
+    if (seg.length_in_sequence_space() > 0 and _sender.segments_out().empty() and not _delay_ack(seg, in_order)) {
+        _sender.send_empty_segment();
+    }
+
+    // respond to a keep-alive (an empty segment with an invalid seqno)
+    if (_receiver.ackno().has_value() and seg.length_in_sequence_space() == 0 and
+        seg.header().seqno == _receiver.ackno().value() - 1 and _sender.segments_out().empty()) {
+        _sender.send_empty_segment();
+    }
+
+    // the inbound stream ended before the outbound one: no need to linger after both finish
+    if (_receiver.stream_out().input_ended() and not _sender.stream_in().eof()) {
+        _linger_after_streams_finish = false;
+    }
+
+    _send_segments();
+    _check_clean_shutdown();
+}
+
+bool TCPConnection::active() const { return _active; }
 
 size_t TCPConnection::write(const string &data) {
-    DUMMY_CODE(data);
-    return {};
+    const size_t written = _sender.stream_in().write(data);
+    _fill_window_and_send();
+    return written;
+}
+
+size_t TCPConnection::write(string &&data) {
+    const size_t written = _sender.stream_in().write(move(data));
+    _fill_window_and_send();
+    return written;
+}
+
+size_t TCPConnection::write(Buffer data) {
+    const size_t written = _sender.stream_in().write(move(data));
+    _fill_window_and_send();
+    return written;
 }
 
 //! \param[in] ms_since_last_tick number of milliseconds since the last call to this method
-void TCPConnection::tick(const size_t ms_since_last_tick) { DUMMY_CODE(ms_since_last_tick); }
+void TCPConnection::tick(const size_t ms_since_last_tick) {
+    if (not _active) {
+        return;
+    }
+    _time_since_last_segment_received += ms_since_last_tick;
+    _sender.tick(ms_since_last_tick);
+    _receiver.tick(ms_since_last_tick);
 
-void TCPConnection::end_input_stream() {}
+    if (_ack_pending) {
+        _time_ack_pending += ms_since_last_tick;
+        if (_time_ack_pending >= _cfg.delayed_ack_timeout and _sender.segments_out().empty()) {
+            _sender.send_empty_segment();
+        }
+    }
 
-void TCPConnection::connect() {}
+    if (_sender.consecutive_retransmissions() > TCPConfig::MAX_RETX_ATTEMPTS) {
+        _unclean_shutdown(true);
+        return;
+    }
+
+    _send_segments();
+    _check_clean_shutdown();
+}
+
+void TCPConnection::end_input_stream() {
+    _sender.stream_in().end_input();
+    _fill_window_and_send();
+}
+
+void TCPConnection::connect() { _fill_window_and_send(); }
+
+void TCPConnection::_fill_window_and_send() {
+    if (not _active) {
+        return;
+    }
+    _sender.fill_window();
+    _send_segments();
+}
+
+void TCPConnection::_send_segments() {
+    // every segment we send acknowledges everything received so far
+    if (not _sender.segments_out().empty()) {
+        _ack_pending = false;
+        _bytes_since_ack = 0;
+    }
+    while (not _sender.segments_out().empty()) {
+        TCPSegment seg = move(_sender.segments_out().front());
+        _sender.segments_out().pop();
+        if (_receiver.ackno().has_value()) {
+            seg.header().ack = true;
+            seg.header().ackno = _receiver.ackno().value();
+        }
+        // the window in a SYN is never scaled; every SYN carries our MSS, and a SYN offers window scaling and
+        // SACK (a SYN-ACK only accepts an offer)
+        const uint8_t shift = _window_scaling and not seg.header().syn ? _receive_window_shift : 0;
+        seg.header().win = min(_receiver.window_size() >> shift, size_t(numeric_limits<uint16_t>::max()));
+        if (seg.header().syn) {
+            seg.header().options.mss = _cfg.mss;
+            if (_offer_option(_cfg.window_scaling, _window_scaling)) {
+                seg.header().options.window_scale = _receive_window_shift;
+            }
+            seg.header().options.sack_permitted = _offer_option(_cfg.sack, _sack);
+        } else if (_sack) {
+            _receiver.add_sack_blocks(seg.header().options);
+        }
+        seg.header().update_doff();
+        _segments_out.push(move(seg));
+    }
+}
+
+void TCPConnection::_negotiate_options(const TCPHeader &syn) {
+    _window_scaling = _cfg.window_scaling and syn.options.window_scale.has_value();
+    _send_window_shift = _window_scaling ? min(syn.options.window_scale.value(), MAX_WINDOW_SHIFT) : 0;
+    _sack = _cfg.sack and syn.options.sack_permitted;
+    if (syn.options.mss.has_value()) {
+        _sender.set_peer_mss(syn.options.mss.value());
+    }
+}
+
+bool TCPConnection::_delay_ack(const TCPSegment &seg, const bool in_order) {
+    // out-of-order data, data that fills a gap, and SYNs and FINs are acknowledged at once, so the peer's
+    // loss recovery and handshakes are never slowed down
+    if (_cfg.delayed_ack_segments <= 1 or not in_order or seg.header().syn or seg.header().fin) {
+        return false;
+    }
+    _largest_segment_received = max(_largest_segment_received, seg.payload().size());
+    _bytes_since_ack += seg.payload().size();
+    if (_bytes_since_ack >= _cfg.delayed_ack_segments * _largest_segment_received) {
+        return false;
+    }
+    if (not _ack_pending) {
+        _ack_pending = true;
+        _time_ack_pending = 0;
+    }
+    return true;
+}
+
+bool TCPConnection::_offer_option(const bool configured, const bool negotiated) const {
+    return configured and (negotiated or not _receiver.ackno().has_value());
+}
+
+//! \param[in] send_rst is `true` to send a RST segment to the peer
+void TCPConnection::_unclean_shutdown(const bool send_rst) {
+    if (send_rst) {
+        // nothing else queued by the sender goes out after the RST
+        while (not _sender.segments_out().empty()) {
+            _sender.segments_out().pop();
+        }
+        _sender.send_empty_segment();
+        _sender.segments_out().back().header().rst = true;
+        _send_segments();
+    }
+    _sender.stream_in().set_error();
+    _receiver.stream_out().set_error();
+    _linger_after_streams_finish = false;
+    _active = false;
+}
+
+void TCPConnection::_check_clean_shutdown() {
+    const bool inbound_done = _receiver.stream_out().input_ended() and _receiver.unassembled_bytes() == 0;
+    const bool outbound_done = _sender.stream_in().eof() and
+                               _sender.next_seqno_absolute() == _sender.stream_in().bytes_written() + 2 and
+                               _sender.bytes_in_flight() == 0;
+    if (not inbound_done or not outbound_done) {
+        return;
+    }
+    if (not _linger_after_streams_finish or _time_since_last_segment_received >= 10 * _cfg.rt_timeout) {
+        _active = false;
+    }
+}
 
 TCPConnection::~TCPConnection() {
     try {
         if (active()) {
             cerr << "Warning: Unclean shutdown of TCPConnection\n";
-
-            // Your code here: need to send a RST segment to the peer
+            _unclean_shutdown(true);
         }
     } catch (const exception &e) {
-        std::cerr << "Exception destructing TCP FSM: " << e.what() << std::endl;
+        std::cerr << "Exception destructing TCPConnection: " << e.what() << std::endl;
     }
 }
@@ -10,8 +10,8 @@
 class TCPConnection {
   private:
     TCPConfig _cfg;
-    TCPReceiver _receiver{_cfg.recv_capacity};
-    TCPSender _sender{_cfg.send_capacity, _cfg.rt_timeout, _cfg.fixed_isn};
+    TCPReceiver _receiver{_cfg};
+    TCPSender _sender{_cfg};
 
     //! outbound queue of segments that the TCPConnection wants sent
     std::queue<TCPSegment> _segments_out{};
@@ -21,6 +21,62 @@ class TCPConnection {
     //! in case the remote TCPConnection doesn't know we've received its whole stream?
     bool _linger_after_streams_finish{true};
 
+    //! Milliseconds since the last segment was received
+    size_t _time_since_last_segment_received{0};
+
+    //! Is the connection still alive in any way?
+    bool _active{true};
+
+    //! \name Window scaling (RFC 7323)
+    //!@{
+
+    //! Both SYNs carried the window scale option, so the windows in all other segments are scaled
+    bool _window_scaling{false};
+    //! How far the windows we advertise are shifted, if scaling: just enough for the receive capacity to fit
+    uint8_t _receive_window_shift;
+    //! How far the peer's advertised windows are shifted
+    uint8_t _send_window_shift{0};
+    //!@}
+
+    //! Both SYNs carried SACK-permitted (RFC 2018), so segments may carry SACK blocks
+    bool _sack{false};
+
+    //! \name Delayed acknowledgments (RFC 1122 section 4.2.3.2, RFC 5681 section 4.2)
+    //!@{
+
+    //! Data has arrived that no segment we sent has acknowledged yet
+    bool _ack_pending{false};
+    //! Milliseconds since the oldest data waiting for an acknowledgment arrived
+    size_t _time_ack_pending{0};
+    //! Payload received since we last sent a segment
+    size_t _bytes_since_ack{0};
+    //! Largest payload received: the peer's segment size, to count full segments by
+    size_t _largest_segment_received{0};
+
+    //! Whether the acknowledgment of `seg` can wait, for more segments or for data of our own to carry it
+    //! \param[in] in_order `seg` carried data the receiver assembled at once, with no gap before or after it
+    bool _delay_ack(const TCPSegment &seg, const bool in_order);
+    //!@}
+
+    //! Agree on window scaling and SACK (or not) from the peer's SYN, and learn its MSS
+    void _negotiate_options(const TCPHeader &syn);
+
+    //! Whether our SYN offers an option we are configured to use: always in a SYN, only if the peer offered it
+    //! in a SYN-ACK
+    bool _offer_option(const bool configured, const bool negotiated) const;
+
+    //! Let the sender fill the window, then send whatever it produced
+    void _fill_window_and_send();
+
+    //! Move the sender's segments to the outbound queue, stamping them with the receiver's ackno and window
+    void _send_segments();
+
+    //! Abort the connection, optionally telling the peer with a RST segment
+    void _unclean_shutdown(const bool send_rst);
+
+    //! End the connection if both streams are finished (and any lingering is done)
+    void _check_clean_shutdown();
+
   public:
     //! \name "Input" interface for the writer
     //!@{
@@ -32,6 +88,14 @@ class TCPConnection {
     //! \returns the number of bytes from `data` that were actually written.
     size_t write(const std::string &data);
 
+    //! \brief Write data to the outbound byte stream, taking ownership of it (no copy into the stream)
+    //! \returns the number of bytes from `data` that were actually written.
+    size_t write(std::string &&data);
+
+    //! \brief Write a Buffer to the outbound byte stream, sharing its storage (no copy into the stream)
+    //! \returns the number of bytes from `data` that were actually written.
+    size_t write(Buffer data);
+
     //! \returns the number of `bytes` that can be written right now.
     size_t remaining_outbound_capacity() const;
 
@@ -55,6 +119,8 @@ class TCPConnection {
     size_t unassembled_bytes() const;
     //! \brief Number of milliseconds since the last segment was received
     size_t time_since_last_segment_received() const;
+    //! \brief The outbound byte stream (e.g., to account for copies in benchmarks)
+    const ByteStream &outbound_stream() const { return _sender.stream_in(); }
     //!< \brief summarize the state of the sender, receiver, and the connection
     TCPState state() const { return {_sender, _receiver, active(), _linger_after_streams_finish}; };
     //!@}
@@ -68,6 +134,9 @@ class TCPConnection {
     //! Called periodically when time elapses
     void tick(const size_t ms_since_last_tick);
 
+    //! \brief With pacing, ms until tick() will send segments that pacing is holding back (nothing if none are)
+    std::optional<double> time_until_next_send() const { return _sender.time_until_next_send(); }
+
     //! \brief TCPSegments that the TCPConnection has enqueued for transmission.
     //! \note The owner or operating system will dequeue these and
     //! put each one into the payload of a lower-layer datagram (usually Internet datagrams (IP),
@@ -81,7 +150,7 @@ class TCPConnection {
     //!@}
 
     //! Construct a new connection from a configuration
-    explicit TCPConnection(const TCPConfig &cfg) : _cfg{cfg} {}
+    explicit TCPConnection(const TCPConfig &cfg);
 
     //! \name construction and destruction
     //! moving is allowed; copying is disallowed; default construction not possible
@@ -1,11 +1,15 @@
 #include "fd_adapter.hh"
 
+#include <cerrno>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <utility>
 
 using namespace std;
 
+TCPOverUDPSocketAdapter::TCPOverUDPSocketAdapter(UDPSocket &&sock) : _sock(move(sock)) { _sock.set_dont_fragment(); }
+
 //! \details This function first attempts to parse a TCP segment from the next UDP
 //! payload recv()d from the socket.
 //!
@@ -19,23 +23,28 @@ using namespace std;
 //! the result that future outgoing segments go to the sender of the SYN segment.
 //! \returns a std::optional<TCPSegment> that is empty if the segment was invalid or unrelated
 optional<TCPSegment> TCPOverUDPSocketAdapter::read() {
-    auto datagram = _sock.recv();
+    Address source_address{nullptr, 0};
+    Buffer payload;
+    // a datagram too big for the route is dropped, as it would be on the wire, rather than ending the connection
+    if (not _sock.recv(source_address, payload, _route_mtu())) {
+        return {};
+    }
 
     // is it for us?
-    if (not listening() and (datagram.source_address != config().destination)) {
+    if (not listening() and (source_address != config().destination)) {
         return {};
     }
 
     // is the payload a valid TCP segment?
     TCPSegment seg;
-    if (ParseResult::NoError != seg.parse(move(datagram.payload), 0)) {
+    if (ParseResult::NoError != seg.parse(move(payload), 0)) {
         return {};
     }
 
     // should we target this source in all future replies?
     if (listening()) {
         if (seg.header().syn and not seg.header().rst) {
-            config_mutable().destination = datagram.source_address;
+            config_mutable().destination = source_address;
             set_listening(false);
         } else {
             return {};
@@ -45,12 +54,33 @@ optional<TCPSegment> TCPOverUDPSocketAdapter::read() {
     return seg;
 }
 
+//! \details The socket itself is not connected, so a connected socket of its own looks up the route. The
+//! peer's datagrams come in over the same interface as ours go out, so the MTU bounds their size: reading at
+//! it puts each one in a string of the matching size class, rather than of the largest.
+size_t TCPOverUDPSocketAdapter::_route_mtu() {
+    if (_recv_mtu.first != config().destination) {
+        UDPSocket route;
+        route.connect(config().destination);
+        _recv_mtu = {config().destination, route.path_mtu()};
+    }
+    return _recv_mtu.second;
+}
+
 //! Serialize a TCP segment and send it as the payload of a UDP datagram.
+//! \details A datagram too big for the local interface is dropped, like one too big for the path.
 //! \param[in] seg is the TCP segment to write
 void TCPOverUDPSocketAdapter::write(TCPSegment &seg) {
     seg.header().sport = config().source.port();
     seg.header().dport = config().destination.port();
-    _sock.sendto(config().destination, seg.serialize(0));
+    try {
+        PacketBuffer datagram{seg.payload().size()};
+        seg.serialize(datagram);
+        _sock.sendto(config().destination, datagram.str());
+    } catch (const unix_error &e) {
+        if (e.code().value() != EMSGSIZE) {
+            throw;
+        }
+    }
 }
 
 //! Specialize LossyFdAdapter to TCPOverUDPSocketAdapter
@@ -47,9 +47,18 @@ class TCPOverUDPSocketAdapter : public FdAdapterBase {
   private:
     UDPSocket _sock;
 
+    //! The destination whose route MTU datagrams are read at, and that MTU (the largest datagram until the
+    //! destination is known)
+    std::pair<Address, size_t> _recv_mtu{{"0", 0}, BufferPool::MAX_SIZE};
+
+    //! The MTU of the route to config().destination, looked up again whenever the destination changes
+    size_t _route_mtu();
+
   public:
     //! Construct from a UDPSocket sliced into a FileDescriptor
-    explicit TCPOverUDPSocketAdapter(UDPSocket &&sock) : _sock(std::move(sock)) {}
+    //! \details The socket's datagrams are never fragmented, so that the path MTU limits segment size just as
+    //! it would for TCP over IP (see TCPConfig::mtu_probing).
+    explicit TCPOverUDPSocketAdapter(UDPSocket &&sock);
 
     //! Attempts to read and return a TCP segment related to the current connection from a UDP payload
     std::optional<TCPSegment> read();
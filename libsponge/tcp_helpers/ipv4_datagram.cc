@@ -5,6 +5,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 using namespace std;
 
@@ -25,17 +26,16 @@ BufferList IPv4Datagram::serialize() const {
         throw runtime_error("IPv4Datagram::serialize: payload is wrong size");
     }
 
-    IPv4Header header_out = _header;
-    header_out.cksum = 0;
-    const string header_zero_checksum = header_out.serialize();
+    string header_out = _header.serialize();
 
-    // calculate checksum -- taken over header only
+    // calculate checksum -- taken over header only, with the checksum field zero
     InternetChecksum check;
-    check.add(header_zero_checksum);
-    header_out.cksum = check.value();
+    NetUnparser::u16_at(header_out, IPv4Header::CKSUM_OFFSET, 0);
+    check.add(header_out);
+    NetUnparser::u16_at(header_out, IPv4Header::CKSUM_OFFSET, check.value());
 
     BufferList ret;
-    ret.append(header_out.serialize());
+    ret.append(move(header_out));
     ret.append(_payload);
     return ret;
 }
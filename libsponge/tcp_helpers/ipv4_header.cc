@@ -2,6 +2,7 @@
 
 #include "util.hh"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <iomanip>
 #include <sstream>
@@ -74,41 +75,48 @@ ParseResult IPv4Header::parse(NetParser &p) {
     return ParseResult::NoError;
 }
 
-//! Serialize the IPv4Header to a string (does not recompute the checksum)
-string IPv4Header::serialize() const {
+//! Write the fields of `header` to the `4 * header.hlen` bytes at `dest` (does not recompute the checksum)
+static void serialize_at(const IPv4Header &header, char *dest) {
     // sanity checks
-    if (ver != 4) {
+    if (header.ver != 4) {
         throw runtime_error("wrong IP version");
     }
-    if (4 * hlen < IPv4Header::LENGTH) {
+    if (4 * header.hlen < IPv4Header::LENGTH) {
         throw runtime_error("IP header too short");
     }
 
-    string ret;
-    ret.reserve(4 * hlen);
+    char *const end = dest + 4 * header.hlen;
+    const uint8_t first_byte = (header.ver << 4) | (header.hlen & 0xf);
+    NetUnparser::u8(dest, first_byte);   // version and header length
+    NetUnparser::u8(dest, header.tos);   // type of service
+    NetUnparser::u16(dest, header.len);  // length
+    NetUnparser::u16(dest, header.id);   // id
 
-    const uint8_t first_byte = (ver << 4) | (hlen & 0xf);
-    NetUnparser::u8(ret, first_byte);  // version and header length
-    NetUnparser::u8(ret, tos);         // type of service
-    NetUnparser::u16(ret, len);        // length
-    NetUnparser::u16(ret, id);         // id
+    const uint16_t fo_val = (header.df ? 0x4000 : 0) | (header.mf ? 0x2000 : 0) | (header.offset & 0x1fff);
+    NetUnparser::u16(dest, fo_val);  // flags and offset
 
-    const uint16_t fo_val = (df ? 0x4000 : 0) | (mf ? 0x2000 : 0) | (offset & 0x1fff);
-    NetUnparser::u16(ret, fo_val);  // flags and offset
+    NetUnparser::u8(dest, header.ttl);    // time to live
+    NetUnparser::u8(dest, header.proto);  // protocol number
 
-    NetUnparser::u8(ret, ttl);    // time to live
-    NetUnparser::u8(ret, proto);  // protocol number
+    NetUnparser::u16(dest, header.cksum);  // checksum
 
-    NetUnparser::u16(ret, cksum);  // checksum
+    NetUnparser::u32(dest, header.src);  // src address
+    NetUnparser::u32(dest, header.dst);  // dst address
 
-    NetUnparser::u32(ret, src);  // src address
-    NetUnparser::u32(ret, dst);  // dst address
-
-    ret.resize(4 * hlen);  // expand header to advertised size
+    fill(dest, end, 0);  // expand header to advertised size
+}
 
+//! Serialize the IPv4Header to a string (does not recompute the checksum)
+string IPv4Header::serialize() const {
+    string ret(4 * hlen, 0);
+    serialize_at(*this, ret.data());
     return ret;
 }
 
+//! \param[in,out] packet the packet so far, in front of which the header is written (without recomputing the
+//! checksum)
+void IPv4Header::serialize(PacketBuffer &packet) const { serialize_at(*this, packet.push(4 * hlen)); }
+
 uint16_t IPv4Header::payload_length() const { return len - 4 * hlen; }
 
 //! \details This value is needed when computing the checksum of an encapsulated TCP segment.
@@ -130,6 +138,18 @@ uint32_t IPv4Header::pseudo_cksum() const {
     return pcksum;
 }
 
+//! \details The checksum is adjusted for the changed 16-bit word rather than recomputed over the header.
+bool IPv4Header::decrement_ttl() {
+    if (ttl == 0) {
+        return false;
+    }
+    // the TTL shares its 16-bit word with the protocol
+    const uint16_t old_word = (ttl << 8) | proto;
+    --ttl;
+    cksum = InternetChecksum::adjust(cksum, old_word, uint16_t((ttl << 8) | proto));
+    return true;
+}
+
 //! \returns A string with the header's contents
 std::string IPv4Header::to_string() const {
     stringstream ss{};
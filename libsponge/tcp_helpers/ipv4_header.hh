@@ -9,6 +9,7 @@ struct IPv4Header {
     static constexpr size_t LENGTH = 20;         //!< [IPv4](\ref rfc::rfc791) header length, not including options
     static constexpr uint8_t DEFAULT_TTL = 128;  //!< A reasonable default TTL value
     static constexpr uint8_t PROTO_TCP = 6;      //!< Protocol number for [tcp](\ref rfc::rfc793)
+    static constexpr size_t CKSUM_OFFSET = 10;   //!< Offset of the checksum field in the header
 
     //! \struct IPv4Header
     //! ~~~{.txt}
@@ -52,9 +53,16 @@ struct IPv4Header {
     //! Serialize the IP fields
     std::string serialize() const;
 
+    //! Push the serialized IP fields in front of `packet`
+    void serialize(PacketBuffer &packet) const;
+
     //! Length of the payload
     uint16_t payload_length() const;
 
+    //! Decrement the TTL, as a router forwarding the datagram does, adjusting `cksum` to match (RFC 1624)
+    //! \returns `false`, leaving the header unchanged, if the TTL is already 0 (the datagram must be dropped)
+    bool decrement_ttl();
+
     //! [pseudo-header's](\ref rfc::rfc793) contribution to the TCP checksum
     uint32_t pseudo_cksum() const;
 
@@ -2,6 +2,7 @@
 #define SPONGE_LIBSPONGE_LOSSY_FD_ADAPTER_HH
 
 #include "file_descriptor.hh"
+#include "ipv4_header.hh"
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
 #include "util.hh"
@@ -47,10 +48,18 @@ class LossyFdAdapter {
         return ret;
     }
 
+    //! \brief Determine whether a segment is too large for the configured path MTU
+    //! \param[in] seg is the segment about to be written
+    //! \returns `true` if the IPv4 datagram carrying `seg` would be larger than FdAdapterConfig::mtu
+    bool _too_large(const TCPSegment &seg) const {
+        const uint16_t mtu = _adapter.config().mtu;
+        return mtu != 0 && IPv4Header::LENGTH + 4 * seg.header().doff + seg.payload().size() > mtu;
+    }
+
     //! \brief Write to the underlying AdapterT instance, potentially dropping the datagram to be written
     //! \param[in] seg is the packet to either write or drop
     void write(TCPSegment &seg) {
-        if (_should_drop(true)) {
+        if (_should_drop(true) || _too_large(seg)) {
             return;
         }
         return _adapter.write(seg);
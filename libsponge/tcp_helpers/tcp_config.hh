@@ -16,10 +16,33 @@ class TCPConfig {
     static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
     static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
 
+    //! Congestion-control algorithm for the sender (see CongestionController)
+    enum class CongestionControl {
+        None,   //!< No congestion window: send whatever the receiver's window allows
+        Reno,   //!< Slow start and AIMD congestion avoidance (RFC 5681)
+        Cubic,  //!< Cubic window growth after a loss (RFC 8312)
+        BBR     //!< Window sized from the measured bottleneck bandwidth and minimum RTT
+    };
+
     uint16_t rt_timeout = TIMEOUT_DFLT;       //!< Initial value of the retransmission timeout, in milliseconds
+    bool adaptive_rto = false;                //!< Compute the retransmission timeout from RTT samples (RFC 6298)
+    uint16_t rt_timeout_min = 20;             //!< With adaptive_rto, lower bound on the retransmission timeout
+    uint16_t rt_timeout_max = 60000;          //!< With adaptive_rto, upper bound on the retransmission timeout
+    bool fast_retransmit = false;             //!< Retransmit on the third duplicate ACK, with NewReno recovery
+    bool window_scaling = false;              //!< Offer the window scale option (RFC 7323) in the SYN
+    bool sack = false;                        //!< Offer selective acknowledgments (RFC 2018) in the SYN
+    uint16_t mss = MAX_PAYLOAD_SIZE;          //!< Largest payload to send, also offered in the SYN's MSS option
+    bool mtu_probing = false;                 //!< Start at MAX_PAYLOAD_SIZE and probe up to mss (RFC 4821)
+    bool pacing = false;                      //!< Spread segments over the RTT rather than sending a window at once
+    uint64_t pacing_rate = 0;                 //!< With pacing, a fixed rate in bytes/s (0: the window per SRTT)
+    unsigned delayed_ack_segments = 1;        //!< Acknowledge in-order data every this many full segments
+    uint16_t delayed_ack_timeout = 40;        //!< With delayed ACKs, longest an acknowledgment waits, in ms
     size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
+    bool recv_autotuning = false;             //!< Grow the receive capacity while the application keeps up
+    size_t recv_capacity_max = 4'000'000;     //!< With recv_autotuning, the most it grows to, in bytes
     size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
     std::optional<WrappingInt32> fixed_isn{};
+    CongestionControl congestion_control = CongestionControl::None;  //!< Congestion-control algorithm
 };
 
 //! Config for classes derived from FdAdapter
@@ -30,6 +53,7 @@ class FdAdapterConfig {
 
     uint16_t loss_rate_dn = 0;  //!< Downlink loss rate (for LossyFdAdapter)
     uint16_t loss_rate_up = 0;  //!< Uplink loss rate (for LossyFdAdapter)
+    uint16_t mtu = 0;           //!< Largest outgoing IPv4 datagram; larger ones are dropped (for LossyFdAdapter)
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_CONFIG_HH
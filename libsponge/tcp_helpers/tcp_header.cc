@@ -1,5 +1,8 @@
 #include "tcp_header.hh"
 
+#include "util.hh"
+
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
@@ -14,6 +17,7 @@ using namespace std;
 //! - the header's `doff` field is shorter than the minimum allowed
 //! - there is less data in the header than the `doff` field claims
 //! - the checksum is bad
+//! - an option's length runs past the end of the header
 ParseResult TCPHeader::parse(NetParser &p) {
     sport = p.u16();                 // source port
     dport = p.u16();                 // destination port
@@ -37,8 +41,14 @@ ParseResult TCPHeader::parse(NetParser &p) {
         return ParseResult::HeaderTooShort;
     }
 
-    // skip any options or anything extra in the header
-    p.remove_prefix(doff * 4 - TCPHeader::LENGTH);
+    // the options fill the rest of the header
+    const size_t options_length = doff * 4 - TCPHeader::LENGTH;
+    options = {};
+    if (not p.error() and p.buffer().size() >= options_length and
+        not options.parse(p.buffer().str().substr(0, options_length))) {
+        return ParseResult::TruncatedPacket;
+    }
+    p.remove_prefix(options_length);
 
     if (p.error()) {
         return p.get_error();
@@ -47,36 +57,56 @@ ParseResult TCPHeader::parse(NetParser &p) {
     return ParseResult::NoError;
 }
 
-//! Serialize the TCPHeader to a string (does not recompute the checksum)
-string TCPHeader::serialize() const {
+//! Write the fields of `header` to the `4 * header.doff` bytes at `dest` (does not recompute the checksum)
+static void serialize_at(const TCPHeader &header, char *dest) {
     // sanity check
-    if (doff < 5) {
+    if (header.doff < 5) {
         throw runtime_error("TCP header too short");
     }
+    if (4 * header.doff < TCPHeader::LENGTH + header.options.length()) {
+        throw runtime_error("TCP options do not fit in the header");
+    }
 
-    string ret;
-    ret.reserve(4 * doff);
+    char *const end = dest + 4 * header.doff;
+    NetUnparser::u16(dest, header.sport);              // source port
+    NetUnparser::u16(dest, header.dport);              // destination port
+    NetUnparser::u32(dest, header.seqno.raw_value());  // sequence number
+    NetUnparser::u32(dest, header.ackno.raw_value());  // ack number
+    NetUnparser::u8(dest, header.doff << 4);           // data offset
 
-    NetUnparser::u16(ret, sport);              // source port
-    NetUnparser::u16(ret, dport);              // destination port
-    NetUnparser::u32(ret, seqno.raw_value());  // sequence number
-    NetUnparser::u32(ret, ackno.raw_value());  // ack number
-    NetUnparser::u8(ret, doff << 4);           // data offset
+    const uint8_t fl_b = (header.urg ? 0b0010'0000 : 0) | (header.ack ? 0b0001'0000 : 0) |
+                         (header.psh ? 0b0000'1000 : 0) | (header.rst ? 0b0000'0100 : 0) |
+                         (header.syn ? 0b0000'0010 : 0) | (header.fin ? 0b0000'0001 : 0);
+    NetUnparser::u8(dest, fl_b);         // flags
+    NetUnparser::u16(dest, header.win);  // window size
 
-    const uint8_t fl_b = (urg ? 0b0010'0000 : 0) | (ack ? 0b0001'0000 : 0) | (psh ? 0b0000'1000 : 0) |
-                         (rst ? 0b0000'0100 : 0) | (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0);
-    NetUnparser::u8(ret, fl_b);  // flags
-    NetUnparser::u16(ret, win);  // window size
+    NetUnparser::u16(dest, header.cksum);  // checksum
 
-    NetUnparser::u16(ret, cksum);  // checksum
+    NetUnparser::u16(dest, header.uptr);  // urgent pointer
 
-    NetUnparser::u16(ret, uptr);  // urgent pointer
+    header.options.serialize(dest);  // options
 
-    ret.resize(4 * doff);  // expand header to advertised size
+    fill(dest, end, 0);  // expand header to advertised size
+}
 
+//! Serialize the TCPHeader to a string (does not recompute the checksum)
+string TCPHeader::serialize() const {
+    string ret(4 * doff, 0);
+    serialize_at(*this, ret.data());
     return ret;
 }
 
+//! \param[in,out] packet the packet so far, in front of which the header is written (without recomputing the
+//! checksum)
+void TCPHeader::serialize(PacketBuffer &packet) const { serialize_at(*this, packet.push(4 * doff)); }
+
+void TCPHeader::update_doff() {
+    if (options.length() > TCPOptions::MAX_LENGTH) {
+        throw runtime_error("TCP options too long");
+    }
+    doff = (TCPHeader::LENGTH + options.length()) / 4;
+}
+
 //! \returns A string with the header's contents
 string TCPHeader::to_string() const {
     stringstream ss{};
@@ -89,7 +119,8 @@ string TCPHeader::to_string() const {
        << " fin: " << fin << '\n'
        << "TCP winsize: " << +win << '\n'
        << "TCP cksum: " << +cksum << '\n'
-       << "TCP uptr: " << +uptr << '\n';
+       << "TCP uptr: " << +uptr << '\n'
+       << "TCP options:" << options.to_string() << '\n';
     return ss.str();
 }
 
@@ -100,9 +131,26 @@ string TCPHeader::summary() const {
     return ss.str();
 }
 
+void TCPHeader::set_ports(const uint16_t new_sport, const uint16_t new_dport) {
+    cksum = InternetChecksum::adjust(cksum, sport, new_sport);
+    cksum = InternetChecksum::adjust(cksum, dport, new_dport);
+    sport = new_sport;
+    dport = new_dport;
+}
+
+void TCPHeader::set_ackno(const WrappingInt32 new_ackno) {
+    cksum = InternetChecksum::adjust(cksum, ackno.raw_value(), new_ackno.raw_value());
+    ackno = new_ackno;
+}
+
+void TCPHeader::set_win(const uint16_t new_win) {
+    cksum = InternetChecksum::adjust(cksum, win, new_win);
+    win = new_win;
+}
+
 bool TCPHeader::operator==(const TCPHeader &other) const {
     // TODO(aozdemir) more complete check (right now we omit cksum, src, dst
     return seqno == other.seqno && ackno == other.ackno && doff == other.doff && urg == other.urg && ack == other.ack &&
            psh == other.psh && rst == other.rst && syn == other.syn && fin == other.fin && win == other.win &&
-           uptr == other.uptr;
+           uptr == other.uptr && options == other.options;
 }
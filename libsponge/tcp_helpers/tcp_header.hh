@@ -2,12 +2,14 @@
 #define SPONGE_LIBSPONGE_TCP_HEADER_HH
 
 #include "parser.hh"
+#include "tcp_options.hh"
 #include "wrapping_integers.hh"
 
 //! \brief [TCP](\ref rfc::rfc793) segment header
-//! \note TCP options are not supported
+//! \note `doff` must leave room for the `options` (see update_doff())
 struct TCPHeader {
-    static constexpr size_t LENGTH = 20;  //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t LENGTH = 20;        //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t CKSUM_OFFSET = 16;  //!< Offset of the checksum field in the header
 
     //! \struct TCPHeader
     //! ~~~{.txt}
@@ -48,6 +50,7 @@ struct TCPHeader {
     uint16_t win = 0;           //!< window size
     uint16_t cksum = 0;         //!< checksum
     uint16_t uptr = 0;          //!< urgent pointer
+    TCPOptions options{};       //!< options
     //!@}
 
     //! Parse the TCP fields from the provided NetParser
@@ -56,6 +59,19 @@ struct TCPHeader {
     //! Serialize the TCP fields
     std::string serialize() const;
 
+    //! Push the serialized TCP fields in front of `packet`
+    void serialize(PacketBuffer &packet) const;
+
+    //! Set `doff` to the smallest value with room for the options (call after changing them)
+    void update_doff();
+
+    //! \name Change a field, adjusting `cksum` to match (RFC 1624) instead of summing the segment again
+    //!@{
+    void set_ports(const uint16_t new_sport, const uint16_t new_dport);
+    void set_ackno(const WrappingInt32 new_ackno);
+    void set_win(const uint16_t new_win);
+    //!@}
+
     //! Return a string containing a header in human-readable format
     std::string to_string() const;
 
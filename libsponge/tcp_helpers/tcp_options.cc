@@ -0,0 +1,178 @@
+#include "tcp_options.hh"
+
+#include "parser.hh"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+//! \param[in] data the encoded option
+//! \param[in] pos offset of the first byte to read
+//! \returns the big-endian integer at `pos`
+template <typename T>
+static T read_int(const string_view data, const size_t pos) {
+    T ret = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        ret = (ret << 8) | static_cast<uint8_t>(data[pos + i]);
+    }
+    return ret;
+}
+
+//! \param[in] data is the option space of a header, as many bytes as `doff` leaves after the fixed header
+//! \returns true if every option was well formed
+//! \details An option of a known kind with the wrong length is kept as an unknown option.
+bool TCPOptions::parse(const string_view data) {
+    *this = {};
+    if (data.size() > MAX_LENGTH) {
+        return false;
+    }
+
+    size_t pos = 0;
+    while (pos < data.size()) {
+        const uint8_t kind = data[pos];
+        if (kind == END) {
+            // the rest is padding
+            break;
+        }
+        if (kind == NOP) {
+            ++pos;
+            continue;
+        }
+
+        // everything else is kind, length (counting both), then data
+        if (pos + 1 == data.size()) {
+            return false;
+        }
+        const uint8_t length = data[pos + 1];
+        if (length < 2 or pos + length > data.size()) {
+            return false;
+        }
+        const string_view body = data.substr(pos + 2, length - 2);
+
+        if (kind == MSS and body.size() == 2) {
+            mss = read_int<uint16_t>(body, 0);
+        } else if (kind == WINDOW_SCALE and body.size() == 1) {
+            window_scale = body[0];
+        } else if (kind == SACK_PERMITTED and body.empty()) {
+            sack_permitted = true;
+        } else if (kind == TIMESTAMPS and body.size() == 8) {
+            timestamps = Timestamps{read_int<uint32_t>(body, 0), read_int<uint32_t>(body, 4)};
+        } else if (kind == SACK and not body.empty() and body.size() % 8 == 0) {
+            sack_block_count = 0;
+            for (size_t block = 0; block < body.size(); block += 8) {
+                add_sack_block(WrappingInt32{read_int<uint32_t>(body, block)},
+                               WrappingInt32{read_int<uint32_t>(body, block + 4)});
+            }
+        } else {
+            copy_n(data.data() + pos, length, _unknown.data() + _unknown_length);
+            _unknown_length += length;
+        }
+        pos += length;
+    }
+
+    return true;
+}
+
+size_t TCPOptions::length() const {
+    size_t ret = 0;
+    ret += mss.has_value() ? 4 : 0;
+    ret += window_scale.has_value() ? 3 : 0;
+    ret += sack_permitted ? 2 : 0;
+    ret += timestamps.has_value() ? 10 : 0;
+    ret += sack_block_count > 0 ? 2 + 8 * sack_block_count : 0;
+    ret += _unknown_length;
+    return (ret + 3) / 4 * 4;
+}
+
+//! \param[in,out] dest where the options go in the serialized header
+//! \details Options are written in a fixed order and END pads the last four-byte word.
+void TCPOptions::serialize(char *&dest) const {
+    if (length() > MAX_LENGTH) {
+        throw runtime_error("TCP options too long");
+    }
+    char *const end = dest + length();
+
+    if (mss.has_value()) {
+        NetUnparser::u8(dest, MSS);
+        NetUnparser::u8(dest, 4);
+        NetUnparser::u16(dest, mss.value());
+    }
+    if (window_scale.has_value()) {
+        NetUnparser::u8(dest, WINDOW_SCALE);
+        NetUnparser::u8(dest, 3);
+        NetUnparser::u8(dest, window_scale.value());
+    }
+    if (sack_permitted) {
+        NetUnparser::u8(dest, SACK_PERMITTED);
+        NetUnparser::u8(dest, 2);
+    }
+    if (timestamps.has_value()) {
+        NetUnparser::u8(dest, TIMESTAMPS);
+        NetUnparser::u8(dest, 10);
+        NetUnparser::u32(dest, timestamps.value().value);
+        NetUnparser::u32(dest, timestamps.value().echo_reply);
+    }
+    if (sack_block_count > 0) {
+        NetUnparser::u8(dest, SACK);
+        NetUnparser::u8(dest, 2 + 8 * sack_block_count);
+        for (size_t i = 0; i < sack_block_count; ++i) {
+            NetUnparser::u32(dest, sack_blocks[i].left.raw_value());
+            NetUnparser::u32(dest, sack_blocks[i].right.raw_value());
+        }
+    }
+    dest = copy(unknown().begin(), unknown().end(), dest);
+
+    dest = fill_n(dest, end - dest, char(END));
+}
+
+bool TCPOptions::add_sack_block(const WrappingInt32 left, const WrappingInt32 right) {
+    if (sack_block_count == MAX_SACK_BLOCKS) {
+        return false;
+    }
+    sack_blocks[sack_block_count++] = {left, right};
+    return true;
+}
+
+//! \returns A string with the options' contents
+string TCPOptions::to_string() const {
+    stringstream ss{};
+    if (mss.has_value()) {
+        ss << " mss: " << mss.value();
+    }
+    if (window_scale.has_value()) {
+        ss << " wscale: " << +window_scale.value();
+    }
+    if (sack_permitted) {
+        ss << " sackOK";
+    }
+    if (timestamps.has_value()) {
+        ss << " ts: " << timestamps.value().value << " ecr: " << timestamps.value().echo_reply;
+    }
+    for (size_t i = 0; i < sack_block_count; ++i) {
+        ss << " sack: [" << sack_blocks[i].left << ", " << sack_blocks[i].right << ")";
+    }
+    if (_unknown_length > 0) {
+        ss << " unknown: " << +_unknown_length << " bytes";
+    }
+    return ss.str();
+}
+
+bool TCPOptions::operator==(const TCPOptions &other) const {
+    if (mss != other.mss or window_scale != other.window_scale or sack_permitted != other.sack_permitted or
+        timestamps.has_value() != other.timestamps.has_value() or sack_block_count != other.sack_block_count or
+        unknown() != other.unknown()) {
+        return false;
+    }
+    if (timestamps.has_value() and (timestamps.value().value != other.timestamps.value().value or
+                                    timestamps.value().echo_reply != other.timestamps.value().echo_reply)) {
+        return false;
+    }
+    for (size_t i = 0; i < sack_block_count; ++i) {
+        if (sack_blocks[i].left != other.sack_blocks[i].left or sack_blocks[i].right != other.sack_blocks[i].right) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+#ifndef SPONGE_LIBSPONGE_TCP_OPTIONS_HH
+#define SPONGE_LIBSPONGE_TCP_OPTIONS_HH
+
+#include "wrapping_integers.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+//! \brief The options carried in a [TCP](\ref rfc::rfc793) header after its fixed 20 bytes
+//! \details The standard options are held in typed fields, and anything else is kept as raw bytes
+//! so that it survives a parse/serialize round trip. Nothing here allocates.
+struct TCPOptions {
+    static constexpr size_t MAX_LENGTH = 40;      //!< Most option space a header can have (doff = 15)
+    static constexpr size_t MAX_SACK_BLOCKS = 4;  //!< Most SACK blocks that fit in the option space
+
+    //! \name Option kinds
+    //!@{
+    static constexpr uint8_t END = 0;
+    static constexpr uint8_t NOP = 1;
+    static constexpr uint8_t MSS = 2;
+    static constexpr uint8_t WINDOW_SCALE = 3;
+    static constexpr uint8_t SACK_PERMITTED = 4;
+    static constexpr uint8_t SACK = 5;
+    static constexpr uint8_t TIMESTAMPS = 8;
+    //!@}
+
+    //! A block of received sequence space, [left, right), beyond the cumulative ACK (RFC 2018)
+    struct SackBlock {
+        WrappingInt32 left{0};
+        WrappingInt32 right{0};
+    };
+
+    //! The timestamps option (RFC 7323)
+    struct Timestamps {
+        uint32_t value{};       //!< TSval: the sender's clock when this segment was sent
+        uint32_t echo_reply{};  //!< TSecr: the most recent TSval received from the peer
+    };
+
+    //! \name Standard options
+    //!@{
+    std::optional<uint16_t> mss{};          //!< Maximum segment size (RFC 793; SYN only)
+    std::optional<uint8_t> window_scale{};  //!< Window shift count (RFC 7323; SYN only)
+    bool sack_permitted{};                  //!< SACK may be used on this connection (RFC 2018; SYN only)
+    std::optional<Timestamps> timestamps{};
+    std::array<SackBlock, MAX_SACK_BLOCKS> sack_blocks{};
+    uint8_t sack_block_count{};
+    //!@}
+
+  private:
+    //! Options of other kinds, each still encoded as kind, length and data
+    std::array<char, MAX_LENGTH> _unknown{};
+    uint8_t _unknown_length{};
+
+  public:
+    //! \brief Parse options from `data` (the bytes between the fixed header and the payload)
+    //! \returns false if an option's length is impossible, in which case the options are unusable
+    bool parse(std::string_view data);
+
+    //! \brief Write the options at `dest`, padded to a multiple of four bytes, and advance `dest` past them
+    //! \note There must be room for length() bytes at `dest`.
+    void serialize(char *&dest) const;
+
+    //! \brief Length of the serialized options, including padding, in bytes
+    size_t length() const;
+
+    //! \brief Add a SACK block, if there is room
+    //! \returns false if all MAX_SACK_BLOCKS are in use
+    bool add_sack_block(const WrappingInt32 left, const WrappingInt32 right);
+
+    //! \brief Options of kinds not listed above, each encoded as kind, length and data
+    std::string_view unknown() const { return {_unknown.data(), _unknown_length}; }
+
+    //! \brief Return a string with the options in human-readable format
+    std::string to_string() const;
+
+    bool operator==(const TCPOptions &other) const;
+    bool operator!=(const TCPOptions &other) const { return not(*this == other); }
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_OPTIONS_HH
@@ -3,9 +3,11 @@
 #include "ipv4_datagram.hh"
 #include "ipv4_header.hh"
 #include "parser.hh"
+#include "util.hh"
 
 #include <arpa/inet.h>
 #include <stdexcept>
+#include <string>
 #include <unistd.h>
 #include <utility>
 
@@ -73,18 +75,44 @@ optional<TCPSegment> TCPOverIPv4Adapter::unwrap_tcp_in_ip(const InternetDatagram
 //! Takes a TCP segment, sets port numbers as necessary, and wraps it in an IPv4 datagram
 //! \param[in] seg is the TCP segment to convert
 InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip(TCPSegment &seg) {
-    // set the port numbers in the TCP segment
-    seg.header().sport = config().source.port();
-    seg.header().dport = config().destination.port();
-
     // create an Internet Datagram and set its addresses and length
     InternetDatagram ip_dgram;
-    ip_dgram.header().src = config().source.ipv4_numeric();
-    ip_dgram.header().dst = config().destination.ipv4_numeric();
-    ip_dgram.header().len = ip_dgram.header().hlen * 4 + seg.header().doff * 4 + seg.payload().size();
+    ip_dgram.header() = _ip_header_for(seg);
 
     // set payload, calculating TCP checksum using information from IP header
     ip_dgram.payload() = seg.serialize(ip_dgram.header().pseudo_cksum());
 
     return ip_dgram;
 }
+
+//! \param[in] seg is the TCP segment to convert
+//! \details The same packet as `wrap_tcp_in_ip(seg).serialize()`, but written to a single buffer: the TCP
+//! segment is serialized into it, its payload checksummed in the same pass that copies it there, and then the
+//! IPv4 header is written in front of the segment, in the headroom left for it. Writing the packet out is
+//! one contiguous write.
+PacketBuffer TCPOverIPv4Adapter::serialize_tcp_in_ip(TCPSegment &seg) {
+    const IPv4Header ip_header = _ip_header_for(seg);
+
+    PacketBuffer packet{seg.payload().size()};
+    seg.serialize(packet, ip_header.pseudo_cksum());
+
+    ip_header.serialize(packet);
+    InternetChecksum check;
+    NetUnparser::u16_at(packet.data(), IPv4Header::CKSUM_OFFSET, 0);
+    check.add({packet.data(), size_t(4 * ip_header.hlen)});
+    NetUnparser::u16_at(packet.data(), IPv4Header::CKSUM_OFFSET, check.value());
+
+    return packet;
+}
+
+IPv4Header TCPOverIPv4Adapter::_ip_header_for(TCPSegment &seg) const {
+    // set the port numbers in the TCP segment
+    seg.header().sport = config().source.port();
+    seg.header().dport = config().destination.port();
+
+    IPv4Header ip_header;
+    ip_header.src = config().source.ipv4_numeric();
+    ip_header.dst = config().destination.ipv4_numeric();
+    ip_header.len = ip_header.hlen * 4 + seg.header().doff * 4 + seg.payload().size();
+    return ip_header;
+}
@@ -14,6 +14,13 @@ class TCPOverIPv4Adapter : public FdAdapterBase {
     std::optional<TCPSegment> unwrap_tcp_in_ip(const InternetDatagram &ip_dgram);
 
     InternetDatagram wrap_tcp_in_ip(TCPSegment &seg);
+
+    //! Serialize a TCP segment wrapped in an IPv4 datagram into one contiguous packet
+    PacketBuffer serialize_tcp_in_ip(TCPSegment &seg);
+
+  private:
+    //! Set the segment's port numbers, and make the header of the IPv4 datagram that carries it
+    IPv4Header _ip_header_for(TCPSegment &seg) const;
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_OVER_IP_HH
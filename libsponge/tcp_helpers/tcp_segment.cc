@@ -3,6 +3,11 @@
 #include "parser.hh"
 #include "util.hh"
 
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <variant>
 
 using namespace std;
@@ -17,7 +22,9 @@ ParseResult TCPSegment::parse(const Buffer buffer, const uint32_t datagram_layer
     }
 
     NetParser p{buffer};
-    _header.parse(p);
+    if (const auto res = _header.parse(p); res != ParseResult::NoError) {
+        return res;
+    }
     _payload = p.buffer();
     return p.get_error();
 }
@@ -28,18 +35,79 @@ size_t TCPSegment::length_in_sequence_space() const {
 
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
 BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum) const {
-    TCPHeader header_out = _header;
-    header_out.cksum = 0;
+    string header_out = _header.serialize();
 
-    // calculate checksum -- taken over entire segment
-    InternetChecksum check(datagram_layer_checksum);
-    check.add(header_out.serialize());
-    check.add(_payload);
-    header_out.cksum = check.value();
+    // calculate checksum -- taken over entire segment, with the checksum field zero
+    optional<uint16_t> cksum = _cached_cksum(datagram_layer_checksum);
+    if (not cksum.has_value()) {
+        InternetChecksum check(datagram_layer_checksum);
+        NetUnparser::u16_at(header_out, TCPHeader::CKSUM_OFFSET, 0);
+        check.add(header_out);
+        check.add(_payload);
+        cksum = check.value();
+        _cache_cksum(datagram_layer_checksum, cksum.value());
+    }
+    NetUnparser::u16_at(header_out, TCPHeader::CKSUM_OFFSET, cksum.value());
 
     BufferList ret;
-    ret.append(header_out.serialize());
+    ret.append(move(header_out));
     ret.append(_payload);
 
     return ret;
 }
+
+//! \param[in,out] packet an empty packet, which the header is pushed onto and the payload put behind
+//! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+//! \details The payload is summed as it is copied (InternetChecksum::copy_and_add()), so each of its
+//! bytes is read once, rather than once for the checksum and again for the copy. The lower layers can
+//! then push their headers in front of the segment, in the packet's remaining headroom.
+void TCPSegment::serialize(PacketBuffer &packet, const uint32_t datagram_layer_checksum) const {
+    if (packet.size() != 0) {
+        throw runtime_error("TCPSegment::serialize: packet is not empty");
+    }
+    _header.serialize(packet);
+    const size_t header_length = packet.size();
+    char *const payload = packet.put(_payload.size());
+
+    if (const auto cksum = _cached_cksum(datagram_layer_checksum); cksum.has_value()) {
+        NetUnparser::u16_at(packet.data(), TCPHeader::CKSUM_OFFSET, cksum.value());
+        copy(_payload.str().begin(), _payload.str().end(), payload);
+        return;
+    }
+
+    NetUnparser::u16_at(packet.data(), TCPHeader::CKSUM_OFFSET, 0);
+    InternetChecksum check(datagram_layer_checksum);
+    check.add({packet.data(), header_length});
+    check.copy_and_add(_payload, payload);
+    NetUnparser::u16_at(packet.data(), TCPHeader::CKSUM_OFFSET, check.value());
+    _cache_cksum(datagram_layer_checksum, check.value());
+}
+
+optional<uint16_t> TCPSegment::_cached_cksum(const uint32_t datagram_layer_checksum) const {
+    if (not _cksum_cache or not _cksum_cache->has_value()) {
+        return {};
+    }
+    const ChecksumCache &cache = _cksum_cache->value();
+    if (cache.datagram_layer_checksum != datagram_layer_checksum or cache.payload.size() != _payload.size() or
+        cache.payload.str().data() != _payload.str().data()) {
+        return {};
+    }
+
+    TCPHeader adjusted = cache.header;
+    adjusted.set_ports(_header.sport, _header.dport);
+    adjusted.set_ackno(_header.ackno);
+    adjusted.set_win(_header.win);
+    if (not(adjusted == _header)) {
+        return {};
+    }
+    return adjusted.cksum;
+}
+
+void TCPSegment::_cache_cksum(const uint32_t datagram_layer_checksum, const uint16_t cksum) const {
+    if (not _cksum_cache) {
+        return;
+    }
+    ChecksumCache cache{datagram_layer_checksum, _header, _payload};
+    cache.header.cksum = cksum;
+    *_cksum_cache = move(cache);
+}
@@ -5,6 +5,9 @@
 #include "tcp_header.hh"
 
 #include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
 
 //! \brief [TCP](\ref rfc::rfc793) segment
 class TCPSegment {
@@ -12,6 +15,22 @@ class TCPSegment {
     TCPHeader _header{};
     Buffer _payload{};
 
+    //! The checksum serialize() last computed, and what it covered
+    struct ChecksumCache {
+        uint32_t datagram_layer_checksum{};
+        TCPHeader header{};  //!< with `cksum` set to the checksum
+        Buffer payload{};    //!< keeps the payload's storage alive, so its address identifies it
+    };
+    //! Shared by the copies of a segment (see cache_checksum()), so a retransmission can find the checksum
+    //! its first transmission computed; null unless caching
+    std::shared_ptr<std::optional<ChecksumCache>> _cksum_cache{};
+
+    //! \returns the cached checksum adjusted for new ports, ackno and window, if nothing else has changed
+    std::optional<uint16_t> _cached_cksum(const uint32_t datagram_layer_checksum) const;
+
+    //! Remember the checksum just computed, if caching
+    void _cache_cksum(const uint32_t datagram_layer_checksum, const uint16_t cksum) const;
+
   public:
     //! \brief Parse the segment from a string
     ParseResult parse(const Buffer buffer, const uint32_t datagram_layer_checksum = 0);
@@ -19,6 +38,15 @@ class TCPSegment {
     //! \brief Serialize the segment to a string
     BufferList serialize(const uint32_t datagram_layer_checksum = 0) const;
 
+    //! \brief Serialize the segment into an empty `packet`, checksumming the payload as it is copied
+    void serialize(PacketBuffer &packet, const uint32_t datagram_layer_checksum = 0) const;
+
+    //! \brief Cache the checksum, in a cache shared by this segment and the copies made of it from now on
+    //! \details Once one of them has been serialized, serializing another (e.g., a retransmission) whose
+    //! header differs only in its ports, ackno or window adjusts the cached checksum (RFC 1624) instead
+    //! of summing the payload again.
+    void cache_checksum() { _cksum_cache = std::make_shared<std::optional<ChecksumCache>>(); }
+
     //! \name Accessors
     //!@{
     const TCPHeader &header() const { return _header; }
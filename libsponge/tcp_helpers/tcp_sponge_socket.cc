@@ -4,6 +4,8 @@
 #include "tun.hh"
 #include "util.hh"
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <exception>
 #include <iostream>
@@ -24,7 +26,12 @@ template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
     auto base_time = timestamp_ms();
     while (condition()) {
-        auto ret = _eventloop.wait_next_event(TCP_TICK_MS);
+        // wake early if pacing is holding back segments that fall due before the next tick
+        int timeout_ms = TCP_TICK_MS;
+        if (const auto pacing_wait = _tcp.value().time_until_next_send(); pacing_wait.has_value()) {
+            timeout_ms = min(timeout_ms, static_cast<int>(ceil(pacing_wait.value())));
+        }
+        auto ret = _eventloop.wait_next_event(timeout_ms);
         if (ret == EventLoop::Result::Exit or _abort) {
             break;
         }
@@ -95,7 +102,7 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
         _thread_data,
         Direction::In,
         [&] {
-            const auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
+            auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
             const auto len = data.size();
             const auto amount_written = _tcp->write(move(data));
             if (amount_written != len) {
@@ -128,8 +135,7 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
             // the pipe, handling the possibility of a partial
             // write (i.e., only pop what was actually written).
             const size_t amount_to_write = min(size_t(65536), inbound.buffer_size());
-            const std::string buffer = inbound.peek_output(amount_to_write);
-            const auto bytes_written = _thread_data.write(move(buffer), false);
+            const auto bytes_written = _thread_data.write(inbound.peek_views(amount_to_write), false);
             inbound.pop_output(bytes_written);
 
             if (inbound.eof() or inbound.error()) {
@@ -286,6 +292,12 @@ CS144TCPSocket::CS144TCPSocket() : TCPOverIPv4SpongeSocket(TCPOverIPv4OverTunFdA
 void CS144TCPSocket::connect(const Address &address) {
     TCPConfig tcp_config;
     tcp_config.rt_timeout = 100;
+    tcp_config.adaptive_rto = true;
+    tcp_config.fast_retransmit = true;
+    tcp_config.window_scaling = true;
+    tcp_config.sack = true;
+    tcp_config.mss = 1460;
+    tcp_config.mtu_probing = true;
 
     FdAdapterConfig multiplexer_config;
     multiplexer_config.source = {"169.254.144.9", to_string(uint16_t(random_device()()))};
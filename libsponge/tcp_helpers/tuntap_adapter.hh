@@ -18,16 +18,19 @@ class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter {
     explicit TCPOverIPv4OverTunFdAdapter(TunFD &&tun) : _tun(std::move(tun)) {}
 
     //! Attempts to read and parse an IPv4 datagram containing a TCP segment related to the current connection
+    //! \details The datagram is read into a string of the size class that holds the device's MTU.
     std::optional<TCPSegment> read() {
+        Buffer packet;
+        _tun.read(packet, _tun.mtu());
         InternetDatagram ip_dgram;
-        if (ip_dgram.parse(_tun.read()) != ParseResult::NoError) {
+        if (ip_dgram.parse(std::move(packet)) != ParseResult::NoError) {
             return {};
         }
         return unwrap_tcp_in_ip(ip_dgram);
     }
 
-    //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device
-    void write(TCPSegment &seg) { _tun.write(wrap_tcp_in_ip(seg).serialize()); }
+    //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device, as one contiguous packet
+    void write(TCPSegment &seg) { _tun.write(serialize_tcp_in_ip(seg).str()); }
 
     //! Access the underlying TUN device
     operator TunFD &() { return _tun; }
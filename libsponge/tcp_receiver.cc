@@ -2,18 +2,24 @@
 
 #include "iostream"
 
-// Dummy implementation of a TCP receiver
-
-// For Lab 2, please replace with a real implementation that passes the
-// automated checks run by `make check_lab2`.
-
-template <typename... Targs>
-void DUMMY_CODE(Targs &&.../* unused */) {}
+#include <algorithm>
+#include <cstdint>
 
 using namespace std;
 
+TCPReceiver::TCPReceiver(const TCPConfig &config)
+    : _reassembler(config.recv_capacity, StreamReassembler::Engine::Map, ByteStream::Storage::Chunked)
+    , _capacity(config.recv_capacity)
+    , _autotuning(config.recv_autotuning)
+    , _initial_capacity(config.recv_capacity)
+    , _max_capacity(max(config.recv_capacity, config.recv_capacity_max)) {}
+
 void TCPReceiver::segment_received(const TCPSegment &seg) {
-    DUMMY_CODE(seg);
+    if (seg.length_in_sequence_space() > 0) {
+        _time_since_data_received = 0;
+    }
+    // what the application read since does not make room past the shrinking window
+    _shrink();
     switch (_state) {
         case LISTEN: {
             if (!seg.header().syn) {
@@ -21,18 +27,21 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
             }
             _state = SYN_RECV;
             _isn = seg.header().seqno;
-            _reassembler.push_substring(seg.payload().copy(), 0, seg.header().fin);
+            _reassembler.push_substring(seg.payload(), 0, seg.header().fin);
             if (stream_out().input_ended()) {
                 _state = FIN_RECV;
             }
         } break;
         case SYN_RECV: {
-            // a byte with invalid stream index should be ignored
-            if (seg.header().seqno <= _isn) {
+            // a byte with invalid stream index (the SYN's seqno) should be ignored; compare absolute seqnos,
+            // since the raw ones wrap around
+            const uint64_t absolute_seqno = unwrap(seg.header().seqno, _isn, _reassembler.first_unassembled() + 1);
+            if (absolute_seqno == 0) {
                 return;
             }
-            auto index = unwrap(seg.header().seqno - 1, _isn, _reassembler.first_unassembled());
-            _reassembler.push_substring(seg.payload().copy(), index, seg.header().fin);
+            auto index = absolute_seqno - 1;
+            _last_segment_index = index;
+            _reassembler.push_substring(seg.payload(), index, seg.header().fin);
             if (stream_out().input_ended()) {
                 _state = FIN_RECV;
             }
@@ -40,6 +49,71 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
         case FIN_RECV: {
         } break;
     }
+    _autotune();
+}
+
+void TCPReceiver::tick(const size_t ms_since_last_tick) {
+    _elapsed_time += ms_since_last_tick;
+    _time_since_data_received += ms_since_last_tick;
+    _autotune();
+}
+
+void TCPReceiver::_autotune() {
+    if (not _autotuning or _state != SYN_RECV) {
+        return;
+    }
+
+    // time how long the data up to the window's right edge takes to arrive (Linux's tcp_rcv_rtt_measure())
+    if (_rtt_mark.has_value() and _reassembler.first_unassembled() >= _rtt_mark.value().first) {
+        const double sample = max<double>(1, _elapsed_time - _rtt_mark.value().second);
+        // a larger sample may only mean the sender had less to send, so it moves the estimate slowly
+        _rtt = not _rtt.has_value() or sample < _rtt.value() ? sample : 0.875 * _rtt.value() + 0.125 * sample;
+        _rtt_mark.reset();
+    }
+    if (not _rtt_mark.has_value() and window_size() > 0) {
+        _rtt_mark = {_reassembler.first_unassembled() + window_size(), _elapsed_time};
+    }
+
+    // an idle connection gives back what it grew, without taking back any window it advertised, and
+    // starts measuring again when data returns
+    if (_time_since_data_received >= AUTOTUNE_IDLE_TIMEOUT) {
+        if (_capacity > _initial_capacity and not _shrink_edge.has_value()) {
+            _shrink_edge = _reassembler.first_unacceptable();
+        }
+        _shrink();
+        _space = 0;
+        _space_start = {_elapsed_time, stream_out().bytes_read()};
+        return;
+    }
+    _shrink();
+
+    if (not _rtt.has_value() or _elapsed_time - _space_start.first < _rtt.value()) {
+        return;
+    }
+    const size_t copied = stream_out().bytes_read() - _space_start.second;
+    if (copied > _space) {
+        _space = copied;
+        if (min(2 * copied, _max_capacity) > _capacity) {
+            _shrink_edge.reset();
+            _reassembler.set_capacity(min(2 * copied, _max_capacity));
+            _capacity = _reassembler.first_unacceptable() - _reassembler.first_unread();
+        }
+    }
+    _space_start = {_elapsed_time, stream_out().bytes_read()};
+}
+
+//! \details The right edge stays at `_shrink_edge`: the capacity is what the application has not read of the
+//! window up to it, and is done shrinking once that is no more than the initial capacity.
+void TCPReceiver::_shrink() {
+    if (not _shrink_edge.has_value()) {
+        return;
+    }
+    const uint64_t first_unread = _reassembler.first_unread();
+    _reassembler.set_capacity(max<uint64_t>(_initial_capacity, _shrink_edge.value() - first_unread));
+    _capacity = _reassembler.first_unacceptable() - first_unread;
+    if (_capacity <= _initial_capacity) {
+        _shrink_edge.reset();
+    }
 }
 
 optional<WrappingInt32> TCPReceiver::ackno() const {
@@ -55,4 +129,36 @@ optional<WrappingInt32> TCPReceiver::ackno() const {
     }
 }
 
-size_t TCPReceiver::window_size() const { return _reassembler.first_unacceptable() - _reassembler.first_unassembled(); }
+void TCPReceiver::add_sack_blocks(TCPOptions &options) const {
+    if (_state != SYN_RECV or unassembled_bytes() == 0) {
+        return;
+    }
+    // stream index i is at absolute seqno i + 1, after the SYN
+    const auto add = [&](const pair<size_t, size_t> &run) {
+        return options.add_sack_block(wrap(run.first + 1, _isn), wrap(run.second + 1, _isn));
+    };
+
+    optional<pair<size_t, size_t>> recent{};
+    for (auto run = _reassembler.unassembled_run(_reassembler.first_unassembled()); run.has_value();
+         run = _reassembler.unassembled_run(run.value().second)) {
+        if (run.value().first <= _last_segment_index and _last_segment_index < run.value().second) {
+            recent = run;
+            if (not add(run.value())) {
+                return;
+            }
+            break;
+        }
+    }
+    for (auto run = _reassembler.unassembled_run(_reassembler.first_unassembled()); run.has_value();
+         run = _reassembler.unassembled_run(run.value().second)) {
+        if (run != recent and not add(run.value())) {
+            return;
+        }
+    }
+}
+
+size_t TCPReceiver::window_size() const {
+    // while the capacity shrinks, reading does not move the right edge (see _shrink())
+    const uint64_t right_edge = min(_reassembler.first_unacceptable(), _shrink_edge.value_or(UINT64_MAX));
+    return right_edge - _reassembler.first_unassembled();
+}
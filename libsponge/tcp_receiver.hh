@@ -3,10 +3,13 @@
 
 #include "byte_stream.hh"
 #include "stream_reassembler.hh"
+#include "tcp_config.hh"
+#include "tcp_options.hh"
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
 
 #include <optional>
+#include <utility>
 
 //! \brief The "receiver" part of a TCP implementation.
 
@@ -20,15 +23,66 @@ class TCPReceiver {
     //! The maximum number of bytes we'll store.
     size_t _capacity;
 
+    //! \name Receive-window autotuning (dynamic right-sizing, as in Linux's tcp_rcv_space_adjust())
+    //!@{
+
+    //! After this long without data, the capacity returns to its initial size
+    static constexpr size_t AUTOTUNE_IDLE_TIMEOUT = 1000;
+
+    bool _autotuning{false};
+    size_t _initial_capacity;
+    size_t _max_capacity;
+
+    size_t _elapsed_time{};             //!< ms, as the sum of tick()'s arguments
+    size_t _time_since_data_received{};  //!< ms
+
+    //! The receiver's estimate of the RTT, in ms: the time taken to receive a window's worth of data, which
+    //! the sender cannot send faster than one per RTT
+    std::optional<double> _rtt{};
+    //! The stream index that ends the window being timed, and when it was advertised
+    std::optional<std::pair<uint64_t, size_t>> _rtt_mark{};
+
+    //! Bytes the application read in the last measured RTT
+    size_t _space{};
+    //! When the current RTT's measurement began, and bytes_read() then
+    std::pair<size_t, uint64_t> _space_start{};
+
+    //! While the capacity shrinks back to its initial size, the window's right edge (a stream index) when it
+    //! began to: reading does not re-open the window past it, so the window closes as the application reads
+    std::optional<uint64_t> _shrink_edge{};
+
+    //! Update the RTT estimate, and resize the capacity to twice what the application reads per RTT (so the
+    //! window never limits a sender that could go faster), or back to the initial capacity once idle
+    void _autotune();
+
+    //! Bring the capacity down toward its initial size, as far as the application has read up to `_shrink_edge`
+    void _shrink();
+    //!@}
+
     WrappingInt32 _isn{0};
     enum TCPState { LISTEN, SYN_RECV, FIN_RECV } _state{};
 
+    //! Stream index of the first byte of the most recent segment (whose SACK block goes first)
+    uint64_t _last_segment_index{};
+
   public:
     //! \brief Construct a TCP receiver
     //!
     //! \param capacity the maximum number of bytes that the receiver will
     //!                 store in its buffers at any give time.
-    TCPReceiver(const size_t capacity) : _reassembler(capacity), _capacity(capacity) {}
+    //!
+    //! The received payloads are handed to the inbound stream without copying: it keeps them as
+    //! chunks (ByteStream::Storage::Chunked) until the application reads them.
+    TCPReceiver(const size_t capacity)
+        : _reassembler(capacity, StreamReassembler::Engine::Map, ByteStream::Storage::Chunked)
+        , _capacity(capacity)
+        , _initial_capacity(capacity)
+        , _max_capacity(capacity) {}
+
+    //! \brief Construct a TCP receiver from the receiver-side fields of a TCPConfig
+    //! \details With TCPConfig::recv_autotuning, the capacity starts at recv_capacity and grows up to
+    //! recv_capacity_max as the application keeps up.
+    explicit TCPReceiver(const TCPConfig &config);
 
     //! \name Accessors to provide feedback to the remote TCPSender
     //!@{
@@ -51,6 +105,12 @@ class TCPReceiver {
     //! accepted by the receiver) and (b) the sequence number of the
     //! beginning of the window (the ackno).
     size_t window_size() const;
+
+    //! \brief Add SACK blocks (RFC 2018) for the data held beyond the ackno to `options`, as many as fit
+    //!
+    //! The block holding the most recently received segment comes first, so the sender learns of
+    //! it even if the ACK carries only some of the blocks; the rest follow in sequence order.
+    void add_sack_blocks(TCPOptions &options) const;
     //!@}
 
     //! \brief number of bytes stored but not yet reassembled
@@ -59,6 +119,12 @@ class TCPReceiver {
     //! \brief handle an inbound segment
     void segment_received(const TCPSegment &seg);
 
+    //! \brief Notifies the TCPReceiver of the passage of time (only autotuning needs it)
+    void tick(const size_t ms_since_last_tick);
+
+    //! \brief The current capacity, which autotuning may change
+    size_t capacity() const { return _capacity; }
+
     //! \name "Output" interface for the reader
     //!@{
     ByteStream &stream_out() { return _reassembler.stream_out(); }
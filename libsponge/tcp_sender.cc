@@ -3,27 +3,61 @@
 #include "iostream"
 #include "tcp_config.hh"
 
+#include <algorithm>
+#include <cmath>
 #include <random>
 
-// Dummy implementation of a TCP sender
-
-// For Lab 3, please replace with a real implementation that passes the
-// automated checks run by `make check_lab3`.
-
-template <typename... Targs>
-void DUMMY_CODE(Targs &&.../* unused */) {}
-
 using namespace std;
 
 //! \param[in] capacity the capacity of the outgoing byte stream
 //! \param[in] retx_timeout the initial amount of time to wait before retransmitting the oldest outstanding segment
 //! \param[in] fixed_isn the Initial Sequence Number to use, if set (otherwise uses a random ISN)
 TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const std::optional<WrappingInt32> fixed_isn)
-    : _isn(fixed_isn.value_or(WrappingInt32{random_device()()}))
-    , _initial_retransmission_timeout{retx_timeout}
-    , _stream(capacity) {}
+    : TCPSender([&] {
+        TCPConfig config;
+        config.send_capacity = capacity;
+        config.rt_timeout = retx_timeout;
+        config.fixed_isn = fixed_isn;
+        return config;
+    }()) {}
+
+TCPSender::TCPSender(const TCPConfig &config)
+    : _isn(config.fixed_isn.value_or(WrappingInt32{random_device()()}))
+    , _initial_retransmission_timeout{config.rt_timeout}
+    , _stream(config.send_capacity, ByteStream::Storage::Chunked)
+    , _fast_retransmit(config.fast_retransmit)
+    , _max_mss(config.mss)
+    , _mss(config.mtu_probing ? min<size_t>(TCPConfig::MAX_PAYLOAD_SIZE, config.mss) : config.mss)
+    , _mtu_probing(config.mtu_probing)
+    , _mtu_probe_limit(config.mss + 1)
+    , _pacing(config.pacing)
+    , _fixed_pacing_rate(config.pacing_rate / 1000.0)
+    , _congestion_controller(CongestionController::make(config.congestion_control, _mss))
+    , _retransmission_timer(config, _mss) {}
+
+uint64_t TCPSender::bytes_in_flight() const { return _retransmission_timer.bytes_in_flight(); }
+
+uint64_t TCPSender::_send_window() const {
+    if (not _congestion_controller) {
+        return _window_size;
+    }
+    return min<uint64_t>(_window_size, _congestion_window());
+}
+
+uint64_t TCPSender::_congestion_window() const {
+    // during recovery, what duplicate ACKs (or the SACK scoreboard) show has left the network no
+    // longer counts against the congestion window, so each one clocks out a new segment
+    if (not _repairing()) {
+        return _congestion_controller->cwnd();
+    }
+    const uint64_t left_network = _retransmission_timer.delivered_by_duplicates() +
+                                  _retransmission_timer.sacked_bytes() + _retransmission_timer.lost_bytes();
+    return _congestion_controller->cwnd() + left_network;
+}
 
-uint64_t TCPSender::bytes_in_flight() const { return _retransmission_timer.cache_size(); }
+bool TCPSender::_room_to_repair() const {
+    return not _congestion_controller or bytes_in_flight() < _congestion_window();
+}
 
 void TCPSender::fill_window() {
     // state: "CLOSED"
@@ -33,129 +67,529 @@ void TCPSender::fill_window() {
         return;
     }
 
-    // state: "SYN_ACKED" (also)
-    if (stream_in().eof()) {
-        // stream has reached EOF, but FIN flag hasn't been sent yet,
-        // so we should send EOF
-        if (next_seqno_absolute() < stream_in().bytes_written() + 2 && bytes_in_flight() < _window_size) {
-            // take window_size into account
-            send_segment(next_seqno(), false, true);
+    // repair the holes the SACK scoreboard shows before sending new data (RFC 6675 NextSeg())
+    while (_repairing() and _retransmission_timer.lost_bytes() > 0 and _room_to_repair()) {
+        _retransmission_timer.retransmit_lost(segments_out());
+        if (_in_recovery) {
+            ++_fast_retransmissions;
         }
-        return;
     }
+    _conclude_mtu_probe();
+
+    // send segments until the window or the stream runs out
+    const uint64_t send_window = _send_window();
+    bool backlogged = _pacing_held;
+    _pacing_held = false;
+    while (true) {
+        // state: "SYN_ACKED" (also)
+        if (stream_in().eof()) {
+            // stream has reached EOF, but FIN flag hasn't been sent yet,
+            // so we should send EOF
+            if (next_seqno_absolute() < stream_in().bytes_written() + 2 && bytes_in_flight() < send_window) {
+                // take window_size into account
+                send_segment(next_seqno(), false, true);
+            }
+            return;
+        }
+
+        // state: "SYN_ACKED"
+        size_t window_size = send_window >= bytes_in_flight() ? send_window - bytes_in_flight() : 0;
+        size_t payload_size = min(_mss, min(stream_in().buffer_size(), window_size));
+        if (payload_size == 0) {
+            return;
+        }
+        // once probing has raised the MSS, each ACK only frees room for a segment of the old size; rather
+        // than squeeze a short segment into it, wait for the ACKs still to come to make room for a full one
+        // (which also leaves room for the next probe)
+        if (_mtu_probing and payload_size < min(_mss, stream_in().buffer_size()) and bytes_in_flight() > 0 and
+            send_window >= _mss) {
+            return;
+        }
 
-    // state: "SYN_ACKED"
-    size_t window_size = _window_size >= bytes_in_flight() ? _window_size - bytes_in_flight() : 0;
-    size_t payload_size = min(TCPConfig::MAX_PAYLOAD_SIZE, min(stream_in().buffer_size(), window_size));
-    if (payload_size == 0) {
+        // with pacing, new data waits until it is due; tick() sends it then
+        if (_pacing and double(_elapsed_time) < _next_send_time) {
+            _pacing_held = true;
+            return;
+        }
+
+        // a probe carries new data like any other segment, so it waits until there is enough
+        const size_t probe_size = _mtu_probe_size();
+        const bool probe = probe_size > 0 and stream_in().buffer_size() >= probe_size and window_size >= probe_size;
+        if (probe) {
+            payload_size = probe_size;
+        }
+
+        // the last of the buffered data goes out with the FIN, if the window has room for both
+        const bool fin = stream_in().input_ended() && payload_size == stream_in().buffer_size() &&
+                         window_size >= payload_size + 1;
+        send_segment(next_seqno(), false, fin, stream_in().read_buffer(payload_size));
+        if (probe) {
+            _mtu_probe = MTUProbe{_next_seqno, payload_size, _retransmission_timer.resegmentations()};
+        }
+        _pace(payload_size + fin, backlogged);
+        backlogged = true;
+        if (fin) {
+            return;
+        }
+    }
+}
+
+size_t TCPSender::_mtu_probe_size() const {
+    // one probe at a time, and none while repairing losses
+    if (not _mtu_probing or _mtu_probe.has_value() or _repairing() or
+        _mss + MTU_PROBE_GRANULARITY >= _mtu_probe_limit) {
+        return 0;
+    }
+    // most paths carry the largest size the connection allows, so try that first, then search in between
+    return _mtu_probe_limit > _max_mss ? _max_mss : _mss + (_mtu_probe_limit - _mss) / 2;
+}
+
+void TCPSender::_conclude_mtu_probe() {
+    if (not _mtu_probe.has_value()) {
         return;
     }
+    // only a probe is larger than the MSS, so a resegmentation means the probe was retransmitted
+    if (_retransmission_timer.resegmentations() != _mtu_probe.value().resegmentations) {
+        _mtu_probe_limit = _mtu_probe.value().size;
+        _mtu_probe.reset();
+    } else if (_first_unacknowledged() >= _mtu_probe.value().ackno) {
+        _set_mss(_mtu_probe.value().size);
+        _mtu_probe.reset();
+    }
+}
 
-    // buffer that is not empty should be sent and stream has EOF
-    if (stream_in().input_ended() && window_size >= payload_size + 1) {
-        send_segment(next_seqno(), false, true, stream_in().read(payload_size));
+double TCPSender::_pacing_rate() const {
+    if (not _pacing or _fixed_pacing_rate > 0) {
+        return _fixed_pacing_rate;
+    }
+    // there is nothing to derive a rate from before the first RTT sample
+    const optional<double> srtt = smoothed_rtt();
+    if (not srtt.has_value() or srtt.value() <= 0) {
+        return 0;
+    }
+    if (_congestion_controller) {
+        return _congestion_controller->pacing_rate(srtt.value());
+    }
+    return _window_size / srtt.value();
+}
+
+void TCPSender::_pace(const size_t bytes, const bool backlogged) {
+    const double rate = _pacing_rate();
+    if (rate <= 0) {
         return;
     }
+    // while segments wait, the schedule is kept even when the clock's coarse ticks leave it behind, so each
+    // tick sends everything that fell due since the last; after a pause it restarts from now, with no burst
+    const double start = backlogged ? _next_send_time : max(_next_send_time, double(_elapsed_time));
+    _next_send_time = start + bytes / rate;
+}
 
-    send_segment(next_seqno(), false, false, stream_in().read(payload_size));
+optional<double> TCPSender::time_until_next_send() const {
+    if (not _pacing_held) {
+        return {};
+    }
+    return max(0.0, _next_send_time - double(_elapsed_time));
+}
 
-    // window_size still has space
-    fill_window();
+void TCPSender::_set_mss(const size_t mss) {
+    _mss = mss;
+    _retransmission_timer.set_mss(mss);
+    if (_congestion_controller) {
+        _congestion_controller->set_mss(mss);
+    }
+}
+
+void TCPSender::set_peer_mss(const size_t mss) {
+    // an MSS of zero would stall the connection
+    if (mss == 0) {
+        return;
+    }
+    _max_mss = min(_max_mss, mss);
+    _mtu_probe_limit = min(_mtu_probe_limit, _max_mss + 1);
+    _set_mss(min(_mss, _max_mss));
 }
 
 //! \param ackno The remote receiver's ackno (acknowledgment number)
-//! \param window_size The remote receiver's advertised window size
-void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_size) {
-    DUMMY_CODE(ackno, window_size);
+//! \param window_size The remote receiver's advertised window size (after any window scaling)
+//! \param pure whether the acknowledgment came on a segment with no payload, SYN or FIN
+void TCPSender::ack_received(const WrappingInt32 ackno, const size_t window_size, const bool pure) {
+    const uint64_t absolute_ackno = unwrap(ackno, _isn, next_seqno_absolute());
+    const size_t new_window_size = window_size != 0 ? window_size : 1;
+
+    // a duplicate ACK repeats the last one exactly, while data is outstanding (RFC 5681 section 2)
+    const bool duplicate = pure and bytes_in_flight() > 0 and absolute_ackno == _first_unacknowledged() and
+                           new_window_size == _window_size and (window_size != 0) == _nonzero;
+
     _nonzero = window_size != 0;
-    _window_size = window_size != 0 ? window_size : 1;
-    _retransmission_timer.stop(ackno.raw_value());
+    _window_size = new_window_size;
+
+    if (duplicate) {
+        _duplicate_ack_received();
+        _conclude_mtu_probe();
+        return;
+    }
+
+    auto ack = _retransmission_timer.stop(absolute_ackno, _elapsed_time);
+    if (not ack.has_value()) {
+        return;
+    }
+    _duplicate_acks = 0;
+
+    if (_in_recovery) {
+        // the ACK that ends recovery may cover many segments at once; it does not grow the window either
+        ack.value().in_recovery = true;
+        if (absolute_ackno >= _recover) {
+            // everything outstanding when recovery began is acknowledged
+            _in_recovery = false;
+        } else if (not _sack) {
+            // a partial ACK: the segment after the one just repaired was lost too, so repair it now
+            _retransmission_timer.retransmit(segments_out());
+            ++_fast_retransmissions;
+        } else {
+            // with SACK, fill_window() repairs it along with anything else the scoreboard shows missing
+            _retransmission_timer.mark_oldest_lost();
+        }
+    }
+
+    _conclude_mtu_probe();
+
+    if (_congestion_controller) {
+        _congestion_controller->on_ack(ack.value());
+    }
+}
+
+void TCPSender::sack_received(const TCPOptions &options) {
+    for (size_t i = 0; i < options.sack_block_count; ++i) {
+        const uint64_t left = unwrap(options.sack_blocks[i].left, _isn, next_seqno_absolute());
+        const uint64_t right = unwrap(options.sack_blocks[i].right, _isn, next_seqno_absolute());
+        // blocks that are stale, or beyond what was sent, are ignored
+        if (left < right and left >= _first_unacknowledged() and right <= next_seqno_absolute()) {
+            _retransmission_timer.sack(left, right);
+            _sack = true;
+        }
+    }
+    if (_sack) {
+        _retransmission_timer.mark_lost((DUPLICATE_ACK_THRESHOLD - 1) * _mss);
+    }
+}
+
+void TCPSender::_duplicate_ack_received() {
+    // with SACK, the scoreboard already knows what arrived
+    if (not _sack) {
+        _retransmission_timer.duplicate_ack_received();
+    }
+    if (not _fast_retransmit) {
+        return;
+    }
+    ++_duplicate_acks;
+
+    // only start a new recovery once the last one (or the last timeout) is over, since duplicate
+    // ACKs for segments sent before then say nothing new
+    const bool lost = _duplicate_acks == DUPLICATE_ACK_THRESHOLD or (_sack and _retransmission_timer.oldest_lost());
+    if (_in_recovery or not lost or _first_unacknowledged() <= _recover) {
+        return;
+    }
+
+    _in_recovery = true;
+    _recover = _next_seqno;
+    _retransmission_timer.retransmit(segments_out());
+    ++_fast_retransmissions;
+    if (_congestion_controller) {
+        _congestion_controller->on_loss(_elapsed_time, bytes_in_flight());
+    }
 }
 
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
 void TCPSender::tick(const size_t ms_since_last_tick) {
-    DUMMY_CODE(ms_since_last_tick);
     _elapsed_time += ms_since_last_tick;
-    _retransmission_timer.tick(ms_since_last_tick, segments_out(), _nonzero);
+    const bool retransmitted = _retransmission_timer.tick(ms_since_last_tick, segments_out(), _nonzero);
+    _conclude_mtu_probe();
+
+    // a zero-window probe going unanswered says nothing about loss or congestion
+    if (retransmitted and _nonzero) {
+        _in_recovery = false;
+        _duplicate_acks = 0;
+        _recover = _next_seqno;
+        // the scoreboard still shows what arrived, so the repairs skip it, and fill_window() makes them as
+        // ACKs open the window again, not one hole per timeout
+        if (_sack) {
+            _retransmission_timer.mark_all_lost();
+        }
+        if (_congestion_controller) {
+            _congestion_controller->on_rto(_elapsed_time, bytes_in_flight());
+        }
+    }
+
+    if (_pacing_held and double(_elapsed_time) >= _next_send_time) {
+        fill_window();
+    }
 }
 
 unsigned int TCPSender::consecutive_retransmissions() const {
     return _retransmission_timer.consecutive_retransmissions();
 }
 
-void TCPSender::send_segment(WrappingInt32 seqno, bool syn, bool fin, std::string &&payload) {
+void TCPSender::send_segment(WrappingInt32 seqno, bool syn, bool fin, Buffer payload) {
     TCPSegment segment;
     segment.header().seqno = seqno;
     segment.header().syn = syn;
     segment.header().fin = fin;
-    if (!payload.empty()) {
-        segment.payload() = std::move(payload);
+    segment.payload() = std::move(payload);
+    if (segment.payload().size() > 0) {
+        // a retransmission then only adjusts the checksum for the new ackno and window
+        segment.cache_checksum();
     }
     segments_out().push(segment);
-    auto ackno = seqno.raw_value() + segment.length_in_sequence_space();
-    _retransmission_timer.start(ackno, segment);
     _next_seqno += segment.length_in_sequence_space();
+    _retransmission_timer.start(_next_seqno, segment, _elapsed_time);
+    if (_congestion_controller) {
+        _congestion_controller->on_send(_elapsed_time, segment.length_in_sequence_space(), bytes_in_flight());
+    }
+}
+
+void TCPSender::send_empty_segment() {
+    TCPSegment segment;
+    segment.header().seqno = next_seqno();
+    segments_out().push(segment);
 }
 
-void TCPSender::send_empty_segment() {}
+TCPSender::RetransmissionTimer::RetransmissionTimer(const TCPConfig &config, const size_t mss)
+    : _initial_retransmission_timeout(config.rt_timeout)
+    , _retransmission_timeout(config.rt_timeout)
+    , _adaptive(config.adaptive_rto)
+    , _min_timeout(config.rt_timeout_min)
+    , _max_timeout(config.rt_timeout_max)
+    , _mss(mss) {}
+
+void TCPSender::RetransmissionTimer::_sample_rtt(const uint64_t rtt) {
+    if (not _srtt.has_value()) {
+        _srtt = rtt;
+        _rttvar = rtt / 2.0;
+        return;
+    }
+    // RTTVAR first, since it uses the old SRTT
+    _rttvar = 0.75 * _rttvar + 0.25 * abs(_srtt.value() - rtt);
+    _srtt = 0.875 * _srtt.value() + 0.125 * rtt;
+}
 
-TCPSender::RetransmissionTimer::RetransmissionTimer(const unsigned int retx_timeout)
-    : _initial_retransmission_timeout(retx_timeout), _retransmission_timeout(retx_timeout) {}
+unsigned int TCPSender::RetransmissionTimer::_estimated_timeout() const {
+    if (not _srtt.has_value()) {
+        return _initial_retransmission_timeout;
+    }
+    // the clock granularity is the 1 ms resolution of tick()
+    const double rto = ceil(_srtt.value() + max(1.0, 4 * _rttvar));
+    return clamp(static_cast<unsigned int>(rto), _min_timeout, _max_timeout);
+}
 
-void TCPSender::RetransmissionTimer::start(const uint32_t ackno, const TCPSegment &segment) {
-    if (_segments_out_cache.empty()) {
+void TCPSender::RetransmissionTimer::start(const uint64_t ackno, const TCPSegment &segment, const uint64_t now) {
+    if (_outstanding.empty()) {
         _elapsed_time = 0;
     }
-    _segments_out_cache[ackno] = segment;
+    _outstanding.push_back({ackno, segment, now, _delivered, false, false, false, false});
+    _bytes_in_flight += segment.length_in_sequence_space();
 }
 
-void TCPSender::RetransmissionTimer::stop(const uint32_t ackno) {
+optional<AckEvent> TCPSender::RetransmissionTimer::stop(const uint64_t ackno, const uint64_t now) {
     // impossible ackno (beyond next seqno) is ignored
-    if (!_segments_out_cache.count(ackno)) {
-        return;
+    if (_outstanding.empty() or ackno > _outstanding.back().ackno) {
+        return {};
+    }
+    // segments are in sequence order, so the acknowledged ones are at the front
+    if (_outstanding.front().ackno > ackno) {
+        return {};
     }
-    std::list<uint32_t> stop_ackno_list{};
-    // think that segment is received whose ackno less than ackno received
-    for (const auto &_segment_pair : _segments_out_cache) {
-        if (_segment_pair.first <= ackno) {
-            stop_ackno_list.emplace_back(_segment_pair.first);
+    AckEvent ack;
+    ack.now = now;
+    bool retransmitted = false;
+    uint64_t sacked = 0;
+    while (not _outstanding.empty() and _outstanding.front().ackno <= ackno) {
+        const Outstanding &acked = _outstanding.front();
+        const uint64_t length = acked.segment.length_in_sequence_space();
+        _bytes_in_flight -= length;
+        ack.bytes_acked += length;
+        if (acked.sacked) {
+            sacked += length;
+        } else if (acked.lost and not acked.repaired) {
+            _lost_bytes -= length;
         }
+        ack.sent_at = acked.sent_at;
+        ack.delivered_at_send = acked.delivered_at_send;
+        retransmitted |= acked.retransmitted;
+        _outstanding.pop_front();
     }
-    if (stop_ackno_list.empty()) {
-        return;
+    // if the ACK covers a retransmission, it may have been held up waiting for it, so no segment it
+    // acknowledges gives an RTT sample (Karn's algorithm)
+    if (not retransmitted) {
+        ack.rtt = now - ack.sent_at;
     }
-    for (auto stop_ackno : stop_ackno_list) {
-        _segments_out_cache.erase(stop_ackno);
+    // whatever SACK blocks or duplicate ACKs already counted as delivered is not delivered again
+    _sacked_bytes -= sacked;
+    const uint64_t counted = min(_delivered_by_duplicates, ack.bytes_acked - sacked);
+    _delivered_by_duplicates -= counted;
+    _delivered += ack.bytes_acked - sacked - counted;
+    ack.bytes_in_flight = _bytes_in_flight;
+    ack.delivered = _delivered;
+
+    if (ack.rtt.has_value()) {
+        _sample_rtt(ack.rtt.value());
     }
     _elapsed_time = 0;
     _retransmission_count = 0;
-    _retransmission_timeout = _initial_retransmission_timeout;
+    if (not _adaptive) {
+        // new data was acknowledged, so the path is delivering again: drop any backoff
+        _retransmission_timeout = _initial_retransmission_timeout;
+    } else if (ack.rtt.has_value()) {
+        // the backoff stays until a segment that was not retransmitted gives a sample (Karn's algorithm):
+        // until then the estimates are those that led to the timeout
+        _retransmission_timeout = _estimated_timeout();
+    }
+    return ack;
+}
+
+void TCPSender::RetransmissionTimer::duplicate_ack_received() {
+    // the segment is not known, so assume a full one, but never more than is outstanding after the hole
+    const uint64_t credit = min<uint64_t>(_mss,
+                                          _bytes_in_flight - min(_bytes_in_flight, _delivered_by_duplicates + 1));
+    _delivered_by_duplicates += credit;
+    _delivered += credit;
+}
+
+void TCPSender::RetransmissionTimer::_retransmit(deque<Outstanding>::iterator it,
+                                                 std::queue<TCPSegment> &segments_out) {
+    // a path MTU probe that needs retransmitting may be too big for the path, so its data goes again in
+    // segments that are known to fit (the first now, the rest as loss recovery or the timer reaches them)
+    if (it->segment.payload().size() > _mss) {
+        it = _resegment(it);
+        ++_resegmentations;
+    }
+    segments_out.push(it->segment);
+    if (it->lost and not it->repaired and not it->sacked) {
+        _lost_bytes -= it->segment.length_in_sequence_space();
+    }
+    it->retransmitted = true;
+    it->repaired = true;
+}
+
+deque<TCPSender::RetransmissionTimer::Outstanding>::iterator TCPSender::RetransmissionTimer::_resegment(
+    deque<Outstanding>::iterator it) {
+    const Outstanding original = *it;
+    const TCPHeader &header = original.segment.header();
+    const Buffer &payload = original.segment.payload();
+
+    vector<Outstanding> pieces;
+    for (size_t offset = 0; offset < payload.size(); offset += _mss) {
+        const size_t length = min(_mss, payload.size() - offset);
+        const bool last = offset + length == payload.size();
+        Outstanding piece = original;
+        piece.ackno = original.ackno - (payload.size() - offset - length) - (header.fin and not last);
+        piece.segment.header().seqno = header.seqno + offset + (header.syn and offset > 0);
+        piece.segment.header().syn = header.syn and offset == 0;
+        piece.segment.header().fin = header.fin and last;
+        piece.segment.payload().remove_prefix(offset);
+        piece.segment.payload().remove_suffix(payload.size() - offset - length);
+        piece.segment.cache_checksum();
+        pieces.push_back(move(piece));
+    }
+    it = _outstanding.erase(it);
+    return _outstanding.insert(it, pieces.begin(), pieces.end());
+}
+
+void TCPSender::RetransmissionTimer::retransmit(std::queue<TCPSegment> &segments_out) {
+    if (_outstanding.empty()) {
+        return;
+    }
+    _retransmit(_outstanding.begin(), segments_out);
+}
+
+void TCPSender::RetransmissionTimer::sack(const uint64_t left, const uint64_t right) {
+    // segments are in sequence order: start from the first that ends after `left`
+    auto it = upper_bound(_outstanding.begin(), _outstanding.end(), left, [](const uint64_t seqno, const auto &o) {
+        return seqno < o.ackno;
+    });
+    for (; it != _outstanding.end() and it->ackno <= right; ++it) {
+        const uint64_t length = it->segment.length_in_sequence_space();
+        if (it->sacked or it->ackno - length < left) {
+            continue;
+        }
+        it->sacked = true;
+        _sacked_bytes += length;
+        _delivered += length;
+        if (it->lost and not it->repaired) {
+            _lost_bytes -= length;
+        }
+    }
+}
+
+void TCPSender::RetransmissionTimer::mark_lost(const uint64_t threshold) {
+    uint64_t sacked_after = 0;
+    for (auto it = _outstanding.rbegin(); it != _outstanding.rend(); ++it) {
+        const uint64_t length = it->segment.length_in_sequence_space();
+        if (it->sacked) {
+            sacked_after += length;
+        } else if (not it->lost and sacked_after > threshold) {
+            it->lost = true;
+            if (not it->repaired) {
+                _lost_bytes += length;
+            }
+        }
+    }
+}
+
+void TCPSender::RetransmissionTimer::mark_oldest_lost() {
+    if (_outstanding.empty() or _outstanding.front().lost or _outstanding.front().sacked) {
+        return;
+    }
+    _outstanding.front().lost = true;
+    if (not _outstanding.front().repaired) {
+        _lost_bytes += _outstanding.front().segment.length_in_sequence_space();
+    }
+}
+
+void TCPSender::RetransmissionTimer::mark_all_lost() {
+    _lost_bytes = 0;
+    for (auto it = _outstanding.begin(); it != _outstanding.end(); ++it) {
+        if (it->sacked) {
+            continue;
+        }
+        it->lost = true;
+        it->repaired = it == _outstanding.begin();
+        if (not it->repaired) {
+            _lost_bytes += it->segment.length_in_sequence_space();
+        }
+    }
+}
+
+void TCPSender::RetransmissionTimer::retransmit_lost(std::queue<TCPSegment> &segments_out) {
+    for (auto it = _outstanding.begin(); it != _outstanding.end(); ++it) {
+        if (it->lost and not it->repaired and not it->sacked) {
+            _retransmit(it, segments_out);
+            return;
+        }
+    }
 }
 
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
-void TCPSender::RetransmissionTimer::tick(const size_t ms_since_last_tick,
+bool TCPSender::RetransmissionTimer::tick(const size_t ms_since_last_tick,
                                           std::queue<TCPSegment> &segments_out,
                                           const bool nonzero) {
-    if (_segments_out_cache.empty()) {
-        return;
+    if (_outstanding.empty()) {
+        return false;
     }
     _elapsed_time += ms_since_last_tick;
     if (_elapsed_time >= _retransmission_timeout) {
-        segments_out.push(_segments_out_cache.begin()->second);
+        _retransmit(_outstanding.begin(), segments_out);
         _elapsed_time = 0;
 
         //! Unlike a zero-size window, a full window of nonzero size should be respected
         //! When filling window, treat a '0' window size as equal to '1' but don't back off RTO
         _retransmission_timeout = nonzero ? 2 * _retransmission_timeout : _retransmission_timeout;
+        if (_adaptive) {
+            _retransmission_timeout = min(_retransmission_timeout, _max_timeout);
+        }
         _retransmission_count++;
+        return true;
     }
+    return false;
 }
 
-uint16_t TCPSender::RetransmissionTimer::cache_size() const {
-    uint64_t count{};
-    for (const auto &segment_pair : _segments_out_cache) {
-        count += segment_pair.second.length_in_sequence_space();
-    }
-    return count;
-}
 unsigned int TCPSender::RetransmissionTimer::consecutive_retransmissions() const { return _retransmission_count; }
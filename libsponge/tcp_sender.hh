@@ -2,14 +2,19 @@
 #define SPONGE_LIBSPONGE_TCP_SENDER_HH
 
 #include "byte_stream.hh"
+#include "congestion_controller.hh"
 #include "tcp_config.hh"
+#include "tcp_options.hh"
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
 
+#include <deque>
 #include <functional>
-#include <list>
-#include <map>
+#include <memory>
+#include <optional>
 #include <queue>
+#include <utility>
+#include <vector>
 
 //! \brief The "sender" part of a TCP implementation.
 
@@ -29,6 +34,7 @@ class TCPSender {
     unsigned int _initial_retransmission_timeout;
 
     //! outgoing stream of bytes that have not yet been sent
+    //! \note chunked, so that segment payloads are slices of the application's writes
     ByteStream _stream;
 
     //! the (absolute) sequence number for the next byte to be sent
@@ -40,34 +46,217 @@ class TCPSender {
 
     bool _nonzero{true};
 
+    //! \name Loss recovery on duplicate ACKs (RFC 5681 fast retransmit, RFC 6582 NewReno fast recovery)
+    //!@{
+    static constexpr unsigned int DUPLICATE_ACK_THRESHOLD = 3;
+
+    bool _fast_retransmit;
+    unsigned int _duplicate_acks{};
+    bool _in_recovery{};
+
+    //! the absolute seqno sent up to when the last recovery (or timeout) began; recovery ends once it is acked
+    uint64_t _recover{};
+
+    unsigned int _fast_retransmissions{};
+
+    //! The lowest absolute seqno not yet acknowledged
+    uint64_t _first_unacknowledged() const { return _next_seqno - bytes_in_flight(); }
+
+    //! Repairing losses from the SACK scoreboard: in recovery, or after a timeout until everything sent
+    //! before it is acknowledged
+    bool _repairing() const { return _in_recovery or (_sack and _first_unacknowledged() < _recover); }
+
+    //! Count a duplicate ACK, and retransmit the oldest segment on the third
+    void _duplicate_ack_received();
+
+    //! The receiver has sent SACK blocks, so recovery follows the scoreboard (RFC 6675) rather
+    //! than repairing one hole per partial ACK
+    bool _sack{};
+    //!@}
+
+    //! \name Segment size: the peer's MSS option, and packetization-layer path MTU discovery (RFC 4821)
+    //!@{
+
+    //! Probing stops once the largest size known to work is within this many bytes of the smallest that failed
+    static constexpr size_t MTU_PROBE_GRANULARITY = 16;
+
+    //! Largest payload the connection allows: the configured MSS, capped by the peer's
+    size_t _max_mss;
+    //! Largest payload put in a segment: `_max_mss`, or with probing, the largest size a probe has confirmed
+    size_t _mss;
+    bool _mtu_probing;
+    //! Smallest payload presumed too big for the path
+    size_t _mtu_probe_limit;
+
+    //! A segment larger than `_mss`, sent to find out whether the path carries it
+    struct MTUProbe {
+        uint64_t ackno;                //!< absolute seqno just past its end
+        size_t size;                   //!< its payload
+        unsigned int resegmentations;  //!< the timer's count of resegmentations when it was sent
+    };
+    std::optional<MTUProbe> _mtu_probe{};
+
+    //! Size of the next probe to send, or 0 if not probing now
+    size_t _mtu_probe_size() const;
+
+    //! Settle the outstanding probe: it worked once acknowledged, and failed if it had to be retransmitted
+    void _conclude_mtu_probe();
+
+    void _set_mss(const size_t mss);
+    //!@}
+
+    //! \name Pacing: releasing new segments at a steady rate rather than a window at a time
+    //!@{
+    bool _pacing;
+    //! Configured rate, in bytes per ms (0: derive it from the window and the smoothed RTT)
+    double _fixed_pacing_rate;
+    //! When (on the sender's clock, in ms) the next new segment may go; fractional, because at high rates
+    //! several segments fall due between one tick and the next
+    double _next_send_time{};
+    //! The last fill_window() stopped because of pacing, with data and window to send more
+    bool _pacing_held{};
+
+    //! Rate to pace at, in bytes per ms, or 0 to send without pacing
+    double _pacing_rate() const;
+
+    //! Move the release schedule past a segment of `bytes` that was just sent
+    //! \param[in] backlogged pacing has been holding segments back since before this one
+    void _pace(const size_t bytes, const bool backlogged);
+    //!@}
+
+    //! congestion control, if any (otherwise only the receiver's window limits what is in flight)
+    std::unique_ptr<CongestionController> _congestion_controller;
+
+    //! How much sequence space may be in flight: the receiver's window, limited by the congestion window
+    uint64_t _send_window() const;
+
+    //! The congestion window, plus (during recovery) what has left the network without being acknowledged
+    //! \pre there is a congestion controller
+    uint64_t _congestion_window() const;
+
+    //! Whether congestion control leaves room to repair a hole the SACK scoreboard shows (RFC 6675 pipe < cwnd);
+    //! repairs fill holes the receiver already has room for, so its window does not limit them
+    bool _room_to_repair() const;
+
     class RetransmissionTimer {
       private:
         unsigned int _initial_retransmission_timeout;
 
         unsigned int _retransmission_timeout;
 
+        //! \name RTT estimation (RFC 6298)
+        //!@{
+        bool _adaptive;  //!< use the estimated RTO (otherwise the initial timeout is used throughout)
+        unsigned int _min_timeout;
+        unsigned int _max_timeout;
+        std::optional<double> _srtt{};  //!< smoothed RTT, in ms, once there has been a sample
+        double _rttvar{};               //!< RTT variation, in ms
+        //!@}
+
+        //! Fold a round-trip time measurement into the estimates
+        void _sample_rtt(const uint64_t rtt);
+
+        //! The retransmission timeout the estimates call for (not backed off)
+        unsigned int _estimated_timeout() const;
+
         size_t _elapsed_time{};
 
         unsigned int _retransmission_count{};
 
-        std::map<uint32_t, TCPSegment> _segments_out_cache{};
+        struct Outstanding {
+            uint64_t ackno;              //!< absolute seqno just past the end of the segment
+            TCPSegment segment;
+            uint64_t sent_at;            //!< when the segment was first sent
+            uint64_t delivered_at_send;  //!< `_delivered` when the segment was first sent
+            bool retransmitted;
+            bool sacked;                 //!< a SACK block showed it arrived
+            bool lost;                   //!< enough data after it has been SACKed to presume it lost
+            bool repaired;               //!< retransmitted since it was last presumed lost
+        };
+
+        //! outstanding segments in sequence order
+        std::deque<Outstanding> _outstanding{};
+
+        //! Send the outstanding segment at `it` again, first split to fit the MSS if it no longer does
+        void _retransmit(std::deque<Outstanding>::iterator it, std::queue<TCPSegment> &segments_out);
+
+        //! Largest payload a retransmission may carry
+        size_t _mss;
+        unsigned int _resegmentations{};
+
+        //! Split the outstanding segment at `it` into segments of at most `_mss` bytes of payload
+        //! \returns the first of them
+        std::deque<Outstanding>::iterator _resegment(std::deque<Outstanding>::iterator it);
+
+        //! sequence space occupied by the outstanding segments
+        uint64_t _bytes_in_flight{};
+
+        //! sequence space acknowledged so far
+        uint64_t _delivered{};
+
+        //! part of `_delivered` credited to duplicate ACKs rather than acknowledged cumulatively
+        uint64_t _delivered_by_duplicates{};
+
+        //! \name The SACK scoreboard: sequence space of outstanding segments that are...
+        //!@{
+        uint64_t _sacked_bytes{};  //!< SACKed (and so also counted in `_delivered`)
+        uint64_t _lost_bytes{};    //!< presumed lost, and not yet repaired
+        //!@}
 
       public:
-        RetransmissionTimer(const unsigned int retx_timeout);
+        RetransmissionTimer(const TCPConfig &config, const size_t mss);
+
+        void set_mss(const size_t mss) { _mss = mss; }
+
+        //! Track a segment sent at time `now`, which ends just before absolute seqno `ackno`
+        void start(const uint64_t ackno, const TCPSegment &segment, const uint64_t now);
+
+        //! Retire the segments that (absolute) `ackno` cumulatively acknowledges
+        //! \returns what the acknowledgment revealed, if it acknowledged anything new
+        std::optional<AckEvent> stop(const uint64_t ackno, const uint64_t now);
+
+        //! A duplicate ACK means a segment after a hole has arrived: count it as delivered
+        void duplicate_ack_received();
+
+        //! Retransmit the oldest outstanding segment now, without backing off the timer
+        void retransmit(std::queue<TCPSegment> &segments_out);
+
+        //! Mark the outstanding segments within absolute seqnos [left, right) as SACKed
+        void sack(const uint64_t left, const uint64_t right);
+
+        //! Presume lost each segment with more than `threshold` bytes SACKed after it (RFC 6675 IsLost())
+        void mark_lost(const uint64_t threshold);
+
+        //! Presume the oldest outstanding segment lost, unless it was SACKed
+        void mark_oldest_lost();
 
-        //! Initialize a Timer for seqno
-        void start(const uint32_t ackno, const TCPSegment &segment);
+        //! After a timeout, presume every segment not SACKed lost, including any retransmission but that of the
+        //! oldest segment, which the timeout just sent (RFC 6675 section 5.1)
+        void mark_all_lost();
 
-        //! Stop a Timer for seqno
-        void stop(const uint32_t ackno);
+        //! Retransmit the oldest segment presumed lost that has not been repaired yet, if any
+        void retransmit_lost(std::queue<TCPSegment> &segments_out);
+
+        bool oldest_lost() const { return not _outstanding.empty() and _outstanding.front().lost; }
 
         //! Check each seqno timer when tick() is called
-        void tick(const size_t ms_since_last_tick, std::queue<TCPSegment> &segments_out, const bool nonzero);
+        //! \returns true if the timer expired and the oldest outstanding segment was retransmitted
+        bool tick(const size_t ms_since_last_tick, std::queue<TCPSegment> &segments_out, const bool nonzero);
 
         unsigned int consecutive_retransmissions() const;
 
-        uint16_t cache_size() const;
-    } _retransmission_timer{_initial_retransmission_timeout};
+        uint64_t bytes_in_flight() const { return _bytes_in_flight; }
+        uint64_t delivered_by_duplicates() const { return _delivered_by_duplicates; }
+        uint64_t sacked_bytes() const { return _sacked_bytes; }
+        uint64_t lost_bytes() const { return _lost_bytes; }
+
+        //! How many outstanding segments have been split because they no longer fit the MSS
+        unsigned int resegmentations() const { return _resegmentations; }
+
+        std::optional<double> smoothed_rtt() const { return _srtt; }
+        double rtt_variation() const { return _rttvar; }
+        unsigned int retransmission_timeout() const { return _retransmission_timeout; }
+    } _retransmission_timer;
 
   public:
     //! Initialize a TCPSender
@@ -75,6 +264,9 @@ class TCPSender {
               const uint16_t retx_timeout = TCPConfig::TIMEOUT_DFLT,
               const std::optional<WrappingInt32> fixed_isn = {});
 
+    //! Initialize a TCPSender from the sender-side fields of a TCPConfig
+    explicit TCPSender(const TCPConfig &config);
+
     //! \name "Input" interface for the writer
     //!@{
     ByteStream &stream_in() { return _stream; }
@@ -85,7 +277,15 @@ class TCPSender {
     //!@{
 
     //! \brief A new acknowledgment was received
-    void ack_received(const WrappingInt32 ackno, const uint16_t window_size);
+    //! \param pure the segment carrying the acknowledgment had no payload, SYN or FIN (only such
+    //! acknowledgments count as duplicates)
+    void ack_received(const WrappingInt32 ackno, const size_t window_size, const bool pure = true);
+
+    //! \brief SACK blocks (RFC 2018) arrived; call before ack_received() for the same segment
+    void sack_received(const TCPOptions &options);
+
+    //! \brief The peer's SYN carried an MSS option: never send it a larger payload
+    void set_peer_mss(const size_t mss);
 
     //! \brief Generate an empty-payload segment (useful for creating empty ACK segments)
     void send_empty_segment();
@@ -108,6 +308,32 @@ class TCPSender {
     //! \brief Number of consecutive retransmissions that have occurred in a row
     unsigned int consecutive_retransmissions() const;
 
+    //! \brief Smoothed round-trip time in ms, once there has been an RTT sample
+    std::optional<double> smoothed_rtt() const { return _retransmission_timer.smoothed_rtt(); }
+
+    //! \brief Round-trip time variation in ms
+    double rtt_variation() const { return _retransmission_timer.rtt_variation(); }
+
+    //! \brief Current retransmission timeout in ms (including any exponential backoff)
+    unsigned int retransmission_timeout() const { return _retransmission_timer.retransmission_timeout(); }
+
+    //! \brief Number of segments retransmitted on duplicate ACKs (rather than on a timeout)
+    unsigned int fast_retransmissions() const { return _fast_retransmissions; }
+
+    //! \brief Largest payload currently put in a segment
+    size_t mss() const { return _mss; }
+
+    //! \brief With pacing, ms until the next segment that pacing is holding back may be sent
+    //! \details tick() sends it once it is due, so an event loop can sleep this long instead of a whole tick.
+    //! \returns nothing if pacing is not holding anything back
+    std::optional<double> time_until_next_send() const;
+
+    //! \brief Sequence space that SACK blocks have acknowledged, beyond the cumulative ACK
+    uint64_t sacked_bytes() const { return _retransmission_timer.sacked_bytes(); }
+
+    //! \brief The congestion controller, or nullptr if congestion control is off
+    const CongestionController *congestion_controller() const { return _congestion_controller.get(); }
+
     //! \brief TCPSegments that the TCPSender has enqueued for transmission.
     //! \note These must be dequeued and sent by the TCPConnection,
     //! which will need to fill in the fields that are set by the TCPReceiver
@@ -125,7 +351,7 @@ class TCPSender {
     WrappingInt32 next_seqno() const { return wrap(_next_seqno, _isn); }
     //!@}
 
-    void send_segment(WrappingInt32 seqno, bool syn = false, bool fin = false, std::string &&payload = std::string{});
+    void send_segment(WrappingInt32 seqno, bool syn = false, bool fin = false, Buffer payload = {});
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_SENDER_HH
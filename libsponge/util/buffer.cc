@@ -1,17 +1,201 @@
 #include "buffer.hh"
 
+#include <new>
+
 using namespace std;
 
+//! The calling thread's free strings, one list per size class, and free reference-count blocks
+struct FreeLists {
+    array<vector<string *>, BufferPool::SIZE_CLASSES.size()> strings{};
+    vector<void *> blocks{};
+    size_t block_size{};  //!< The size of each of the `blocks` (they are all allocated for one type)
+
+    FreeLists() = default;
+    FreeLists(const FreeLists &other) = delete;
+    FreeLists &operator=(const FreeLists &other) = delete;
+    ~FreeLists();
+};
+
+//! Set once the thread's FreeLists are destroyed, after which anything released on the thread is freed
+//! \note Trivially destructible, so it can still be read while the thread's other thread_locals are destroyed
+static thread_local bool free_lists_destroyed = false;
+
+static thread_local FreeLists free_lists;
+
+FreeLists::~FreeLists() {
+    free_lists_destroyed = true;
+    for (const auto &list : strings) {
+        for (string *const str : list) {
+            delete str;
+        }
+    }
+    for (void *const block : blocks) {
+        ::operator delete(block);
+    }
+}
+
+//! \returns the index of the smallest size class that holds `size` bytes, or SIZE_CLASSES.size() if none
+static size_t size_class(const size_t size) {
+    const auto &classes = BufferPool::SIZE_CLASSES;
+    return lower_bound(classes.begin(), classes.end(), size) - classes.begin();
+}
+
+//! Puts a string on the free list of its size class, instead of deleting it (the shared_ptr deleter)
+struct Recycle {
+    void operator()(string *const str) const {
+        const size_t index = size_class(str->size());
+        if (free_lists_destroyed or index == BufferPool::SIZE_CLASSES.size() or
+            str->size() != BufferPool::SIZE_CLASSES[index]) {
+            delete str;
+            return;
+        }
+        auto &list = free_lists.strings[index];
+        if ((list.size() + 1) * str->size() > BufferPool::MAX_FREE_BYTES) {
+            delete str;
+            return;
+        }
+        list.push_back(str);
+    }
+};
+
+//! Recycles the blocks in which `std::shared_ptr` keeps the reference counts of the strings it manages
+template <typename T>
+struct BlockAllocator {
+    using value_type = T;
+
+    BlockAllocator() = default;
+
+    template <typename U>
+    BlockAllocator(const BlockAllocator<U> &) {}
+
+    T *allocate(const size_t n) {
+        const size_t size = n * sizeof(T);
+        if (not free_lists_destroyed and size == free_lists.block_size and not free_lists.blocks.empty()) {
+            void *const block = free_lists.blocks.back();
+            free_lists.blocks.pop_back();
+            return static_cast<T *>(block);
+        }
+        return static_cast<T *>(::operator new(size));
+    }
+
+    void deallocate(T *const block, const size_t n) {
+        const size_t size = n * sizeof(T);
+        if (free_lists_destroyed or (free_lists.block_size != 0 and size != free_lists.block_size) or
+            free_lists.blocks.size() * size >= BufferPool::MAX_FREE_BYTES) {
+            ::operator delete(block);
+            return;
+        }
+        free_lists.block_size = size;
+        free_lists.blocks.push_back(block);
+    }
+
+    template <typename U>
+    bool operator==(const BlockAllocator<U> &) const {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const BlockAllocator<U> &) const {
+        return false;
+    }
+};
+
+//! \details Strings up to MAX_SIZE come from the free list of the smallest size class that holds them, or are
+//! allocated at that size when the list is empty. The string is zero-filled only when first allocated.
+shared_ptr<string> BufferPool::allocate(const size_t size) {
+    const size_t index = size_class(size);
+    if (index == SIZE_CLASSES.size()) {
+        return make_shared<string>(size, 0);
+    }
+
+    string *str = nullptr;
+    if (not free_lists_destroyed and not free_lists.strings[index].empty()) {
+        str = free_lists.strings[index].back();
+        free_lists.strings[index].pop_back();
+    } else {
+        str = new string(SIZE_CLASSES[index], 0);
+    }
+    return {str, Recycle{}, BlockAllocator<string>{}};
+}
+
+size_t BufferPool::free_count(const size_t size) {
+    const size_t index = size_class(size);
+    if (free_lists_destroyed or index == SIZE_CLASSES.size()) {
+        return 0;
+    }
+    return free_lists.strings[index].size();
+}
+
+Buffer::Buffer(shared_ptr<string> storage, const size_t size) : _storage(move(storage)), _size(size) {
+    if (size > (_storage ? _storage->size() : 0)) {
+        throw out_of_range("Buffer: size exceeds storage");
+    }
+    if (_size == 0) {
+        _storage.reset();
+    }
+}
+
 void Buffer::remove_prefix(const size_t n) {
-    if (n > str().size()) {
+    if (n > _size) {
         throw out_of_range("Buffer::remove_prefix");
     }
     _starting_offset += n;
-    if (_storage and _starting_offset == _storage->size()) {
+    _size -= n;
+    if (_storage and _size == 0) {
+        _storage.reset();
+    }
+}
+
+void Buffer::remove_suffix(const size_t n) {
+    if (n > _size) {
+        throw out_of_range("Buffer::remove_suffix");
+    }
+    _size -= n;
+    if (_storage and _size == 0) {
         _storage.reset();
     }
 }
 
+//! \details Storage no bigger than an empty string's inline buffer is never worth copying out of.
+bool Buffer::compact() {
+    if (_storage and 2 * _size < _storage->capacity() and _storage->capacity() > string().capacity()) {
+        *this = Buffer{copy()};
+        return true;
+    }
+    return false;
+}
+
+char *PacketBuffer::push(const size_t n) {
+    if (n > headroom()) {
+        throw out_of_range("PacketBuffer::push");
+    }
+    _head -= n;
+    return data();
+}
+
+char *PacketBuffer::put(const size_t n) {
+    if (n > tailroom()) {
+        throw out_of_range("PacketBuffer::put");
+    }
+    _tail += n;
+    return _storage->data() + _tail - n;
+}
+
+void PacketBuffer::pull(const size_t n) {
+    if (n > size()) {
+        throw out_of_range("PacketBuffer::pull");
+    }
+    _head += n;
+}
+
+Buffer PacketBuffer::release() {
+    Buffer ret{move(_storage), _tail};
+    ret.remove_prefix(_head);
+    _storage.reset();
+    _head = _tail = _end = 0;
+    return ret;
+}
+
 void BufferList::append(const BufferList &other) {
     for (const auto &buf : other._buffers) {
         _buffers.push_back(buf);
@@ -2,6 +2,8 @@
 #define SPONGE_LIBSPONGE_BUFFER_HH
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <deque>
 #include <memory>
 #include <numeric>
@@ -11,17 +13,46 @@
 #include <sys/uio.h>
 #include <vector>
 
-//! \brief A reference-counted read-only string that can discard bytes from the front
+//! \brief Recycles packet-sized strings, so that receiving or building a packet needs no malloc and no zero-filling
+//! \details Strings come in a few size classes and are never resized, so a recycled one is ready to be read into.
+//! Each thread keeps its own free lists, and takes and returns strings without a lock; a string goes back to
+//! the free list of the thread that drops the last reference to it. The blocks in which `std::shared_ptr`
+//! keeps its reference counts are recycled the same way.
+class BufferPool {
+  public:
+    //! Size classes: an Ethernet frame with room for headers, a jumbo frame, and the largest IP datagram
+    static constexpr std::array<size_t, 3> SIZE_CLASSES{2048, 9216, 65536};
+
+    //! Largest string the pool recycles
+    static constexpr size_t MAX_SIZE = SIZE_CLASSES.back();
+
+    //! Most bytes of free strings each thread keeps in each size class (the rest are freed)
+    static constexpr size_t MAX_FREE_BYTES = 4 * 1024 * 1024;
+
+    //! \brief A string of at least `size` bytes, with unspecified contents, recycled once no longer referenced
+    //! \note A string larger than MAX_SIZE is allocated and freed as usual.
+    static std::shared_ptr<std::string> allocate(const size_t size);
+
+    //! \brief Number of strings on the calling thread's free list for the size class that holds `size` bytes
+    static size_t free_count(const size_t size);
+};
+
+//! \brief A reference-counted read-only string that can discard bytes from the front or back
 class Buffer {
   private:
     std::shared_ptr<std::string> _storage{};
     size_t _starting_offset{};
+    size_t _size{};
 
   public:
     Buffer() = default;
 
     //! \brief Construct by taking ownership of a string
-    Buffer(std::string &&str) noexcept : _storage(std::make_shared<std::string>(std::move(str))) {}
+    Buffer(std::string &&str) noexcept
+        : _storage(std::make_shared<std::string>(std::move(str))), _size(_storage->size()) {}
+
+    //! \brief Construct from the first `size` bytes of `storage` (e.g., a string from BufferPool::allocate())
+    Buffer(std::shared_ptr<std::string> storage, const size_t size);
 
     //! \name Expose contents as a std::string_view
     //!@{
@@ -29,7 +60,7 @@ class Buffer {
         if (not _storage) {
             return {};
         }
-        return {_storage->data() + _starting_offset, _storage->size() - _starting_offset};
+        return {_storage->data() + _starting_offset, _size};
     }
 
     operator std::string_view() const { return str(); }
@@ -39,7 +70,7 @@ class Buffer {
     uint8_t at(const size_t n) const { return str().at(n); }
 
     //! \brief Size of the string
-    size_t size() const { return str().size(); }
+    size_t size() const { return _size; }
 
     //! \brief Make a copy to a new std::string
     std::string copy() const { return std::string(str()); }
@@ -47,6 +78,92 @@ class Buffer {
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
     void remove_prefix(const size_t n);
+
+    //! \brief Discard the last `n` bytes of the string (does not require a copy or move)
+    //! \note Together with remove_prefix(), this makes a sub-slice that shares storage with the original.
+    void remove_suffix(const size_t n);
+
+    //! \brief Copy the string into storage of its own if it covers less than half of the storage it shares
+    //! \details Call before keeping a slice for long: until then it holds on to all of its storage (e.g., the
+    //! whole buffer a datagram was read into), however little of it the slice covers.
+    //! \returns `true` if the string was copied
+    bool compact();
+};
+
+//! \brief A packet under construction, with room reserved in front of it for headers and behind it for data
+//! \details Like the Linux kernel's `sk_buff`: the payload is put() in the middle of the storage, and then each
+//! layer, from the top down, push()es its header in front of what the layers above it wrote. The result is one
+//! contiguous packet, built without copying anything but the bytes each layer writes itself.
+class PacketBuffer {
+  private:
+    std::shared_ptr<std::string> _storage;  //!< From the BufferPool
+    size_t _head;                           //!< Index in `_storage` of the first byte of the packet
+    size_t _tail;                           //!< Index in `_storage` just past the last byte of the packet
+    size_t _end;                            //!< Index in `_storage` just past the tailroom
+
+  public:
+    //! Enough headroom for an Ethernet header, and an IPv4 and a TCP header with the most options
+    static constexpr size_t DEFAULT_HEADROOM = 14 + 60 + 60;
+
+    //! \brief Construct an empty packet
+    //! \param[in] tailroom is the room behind the packet, for the payload
+    //! \param[in] headroom is the room in front of the packet, for the headers
+    explicit PacketBuffer(const size_t tailroom, const size_t headroom = DEFAULT_HEADROOM)
+        : _storage(BufferPool::allocate(headroom + tailroom))
+        , _head(headroom)
+        , _tail(headroom)
+        , _end(headroom + tailroom) {}
+
+    //! \name
+    //! A PacketBuffer can be moved, but not copied, as that would share the storage being written
+
+    //!@{
+    PacketBuffer(const PacketBuffer &other) = delete;
+    PacketBuffer &operator=(const PacketBuffer &other) = delete;
+    PacketBuffer(PacketBuffer &&other) = default;
+    PacketBuffer &operator=(PacketBuffer &&other) = default;
+    ~PacketBuffer() = default;
+    //!@}
+
+    //! \brief Extend the packet by `n` bytes at the front
+    //! \returns the new first byte, where the caller writes the `n` bytes
+    //! \throws std::out_of_range if there are fewer than `n` bytes of headroom
+    char *push(const size_t n);
+
+    //! \brief Extend the packet by `n` bytes at the back
+    //! \returns the first of the new bytes, where the caller writes them
+    //! \throws std::out_of_range if there are fewer than `n` bytes of tailroom
+    char *put(const size_t n);
+
+    //! \brief Discard the first `n` bytes of the packet, returning them to the headroom
+    void pull(const size_t n);
+
+    //! \brief Room left in front of the packet
+    size_t headroom() const { return _head; }
+
+    //! \brief Room left behind the packet
+    size_t tailroom() const { return _end - _tail; }
+
+    //! \brief Size of the packet
+    size_t size() const { return _tail - _head; }
+
+    //! \brief The first byte of the packet, to write to
+    char *data() { return _storage ? _storage->data() + _head : nullptr; }
+
+    //! \name Expose contents as a std::string_view
+    //!@{
+    std::string_view str() const {
+        if (not _storage) {
+            return {};
+        }
+        return {_storage->data() + _head, size()};
+    }
+
+    operator std::string_view() const { return str(); }
+    //!@}
+
+    //! \brief Convert to a Buffer that takes over the storage (does not require a copy), leaving the packet empty
+    Buffer release();
 };
 
 //! \brief A reference-counted discontiguous string that can discard bytes from the front
@@ -113,6 +230,9 @@ class BufferViewList {
 
     //! \brief Construct from a std::string_view
     BufferViewList(std::string_view str) { _views.push_back({const_cast<char *>(str.data()), str.size()}); }
+
+    //! \brief Construct from a sequence of std::string_views, in order
+    BufferViewList(std::deque<std::string_view> views) : _views(std::move(views)) {}
     //!@}
 
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
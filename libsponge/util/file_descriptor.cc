@@ -8,6 +8,7 @@
 #include <stdexcept>
 #include <sys/uio.h>
 #include <unistd.h>
+#include <utility>
 
 using namespace std;
 
@@ -50,17 +51,33 @@ void FileDescriptor::read(std::string &str, const size_t limit) {
     constexpr size_t BUFFER_SIZE = 1024 * 1024;  // maximum size of a read
     const size_t size_to_read = min(BUFFER_SIZE, limit);
     str.resize(size_to_read);
+    str.resize(_read(str.data(), size_to_read));
+}
+
+//! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
+//! \param[out] buffer holds the bytes read, in a string from the BufferPool
+//! \details Reading a packet this way neither allocates nor zero-fills memory, once the pool has a string
+//! of the right size class free.
+void FileDescriptor::read(Buffer &buffer, const size_t limit) {
+    const size_t size_to_read = min(BufferPool::MAX_SIZE, limit);
+    auto storage = BufferPool::allocate(size_to_read);
+    const size_t bytes_read = _read(storage->data(), size_to_read);
+    buffer = Buffer{move(storage), bytes_read};
+}
 
-    ssize_t bytes_read = SystemCall("read", ::read(fd_num(), str.data(), size_to_read));
-    if (limit > 0 && bytes_read == 0) {
+//! \param[out] data is where up to `size_to_read` bytes are read to
+//! \returns the number of bytes read
+size_t FileDescriptor::_read(char *data, const size_t size_to_read) {
+    ssize_t bytes_read = SystemCall("read", ::read(fd_num(), data, size_to_read));
+    if (size_to_read > 0 && bytes_read == 0) {
         _internal_fd->_eof = true;
     }
     if (bytes_read > static_cast<ssize_t>(size_to_read)) {
         throw runtime_error("read() read more than requested");
     }
-    str.resize(bytes_read);
 
     register_read();
+    return bytes_read;
 }
 
 //! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
@@ -44,6 +44,9 @@ class FileDescriptor {
     // private constructor used to duplicate the FileDescriptor (increase the reference count)
     explicit FileDescriptor(std::shared_ptr<FDWrapper> other_shared_ptr);
 
+    //! Read up to `size_to_read` bytes to `data`, and update the read count and EOF flag
+    size_t _read(char *data, const size_t size_to_read);
+
   protected:
     void register_read() { ++_internal_fd->_read_count; }    //!< increment read count
     void register_write() { ++_internal_fd->_write_count; }  //!< increment write count
@@ -61,6 +64,9 @@ class FileDescriptor {
     //! Read up to `limit` bytes into `str` (caller can allocate storage)
     void read(std::string &str, const size_t limit = std::numeric_limits<size_t>::max());
 
+    //! Read up to `limit` bytes (at most BufferPool::MAX_SIZE) into `buffer`, drawing its storage from the BufferPool
+    void read(Buffer &buffer, const size_t limit = BufferPool::MAX_SIZE);
+
     //! Write a string, possibly blocking until all is written
     size_t write(const char *str, const bool write_all = true) { return write(BufferViewList(str), write_all); }
 
@@ -59,6 +59,14 @@ void NetUnparser::_unparse_int(string &s, T val) {
     }
 }
 
+template <typename T>
+void NetUnparser::_unparse_int(char *&dest, T val) {
+    constexpr size_t len = sizeof(T);
+    for (size_t i = 0; i < len; ++i) {
+        *dest++ = char((val >> ((len - i - 1) * 8)) & 0xff);
+    }
+}
+
 uint32_t NetParser::u32() { return _parse_int<uint32_t>(); }
 
 uint16_t NetParser::u16() { return _parse_int<uint16_t>(); }
@@ -70,3 +78,19 @@ void NetUnparser::u32(string &s, const uint32_t val) { return _unparse_int<uint3
 void NetUnparser::u16(string &s, const uint16_t val) { return _unparse_int<uint16_t>(s, val); }
 
 void NetUnparser::u8(string &s, const uint8_t val) { return _unparse_int<uint8_t>(s, val); }
+
+void NetUnparser::u16_at(string &s, const size_t offset, const uint16_t val) {
+    s.at(offset) = char(val >> 8);
+    s.at(offset + 1) = char(val & 0xff);
+}
+
+void NetUnparser::u32(char *&dest, const uint32_t val) { return _unparse_int<uint32_t>(dest, val); }
+
+void NetUnparser::u16(char *&dest, const uint16_t val) { return _unparse_int<uint16_t>(dest, val); }
+
+void NetUnparser::u8(char *&dest, const uint8_t val) { return _unparse_int<uint8_t>(dest, val); }
+
+void NetUnparser::u16_at(char *data, const size_t offset, const uint16_t val) {
+    data += offset;
+    u16(data, val);
+}
@@ -74,6 +74,23 @@ struct NetUnparser {
 
     //! Write an 8-bit integer into the data stream in network byte order
     static void u8(std::string &s, const uint8_t val);
+
+    //! Overwrite the 16-bit integer at `offset` in the data stream, in network byte order
+    static void u16_at(std::string &s, const size_t offset, const uint16_t val);
+
+    template <typename T>
+    static void _unparse_int(char *&dest, T val);
+
+    //! \name Write an integer at `dest` in network byte order, and advance `dest` past it
+    //! \note The caller makes sure there is room (e.g., by PacketBuffer::push()ing the whole header first).
+    //!@{
+    static void u32(char *&dest, const uint32_t val);
+    static void u16(char *&dest, const uint16_t val);
+    static void u8(char *&dest, const uint8_t val);
+    //!@}
+
+    //! Overwrite the 16-bit integer at `offset` from `data`, in network byte order
+    static void u16_at(char *data, const size_t offset, const uint16_t val);
 };
 
 #endif  // SPONGE_LIBSPONGE_PARSER_HH
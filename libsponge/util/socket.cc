@@ -3,8 +3,10 @@
 #include "util.hh"
 
 #include <cstddef>
+#include <netinet/in.h>
 #include <stdexcept>
 #include <unistd.h>
+#include <utility>
 
 using namespace std;
 
@@ -84,28 +86,43 @@ void Socket::shutdown(const int how) {
     }
 }
 
-//! \note If `mtu` is too small to hold the received datagram, this method throws a std::runtime_error
-void UDPSocket::recv(received_datagram &datagram, const size_t mtu) {
+size_t UDPSocket::_recv(Address &source_address, char *data, const size_t mtu) {
     // receive source address and payload
     Address::Raw datagram_source_address;
-    datagram.payload.resize(mtu);
-
     socklen_t fromlen = sizeof(datagram_source_address);
 
-    const ssize_t recv_len = SystemCall(
-        "recvfrom",
-        ::recvfrom(
-            fd_num(), datagram.payload.data(), datagram.payload.size(), MSG_TRUNC, datagram_source_address, &fromlen));
+    const ssize_t recv_len =
+        SystemCall("recvfrom", ::recvfrom(fd_num(), data, mtu, MSG_TRUNC, datagram_source_address, &fromlen));
 
-    if (recv_len > ssize_t(mtu)) {
+    register_read();
+    source_address = {datagram_source_address, fromlen};
+    return recv_len;
+}
+
+//! \note If `mtu` is too small to hold the received datagram, this method throws a std::runtime_error
+void UDPSocket::recv(received_datagram &datagram, const size_t mtu) {
+    datagram.payload.resize(mtu);
+    const size_t recv_len = _recv(datagram.source_address, datagram.payload.data(), mtu);
+    if (recv_len > mtu) {
         throw runtime_error("recvfrom (oversized datagram)");
     }
-
-    register_read();
-    datagram.source_address = {datagram_source_address, fromlen};
     datagram.payload.resize(recv_len);
 }
 
+//! \details Receiving a datagram this way neither allocates nor zero-fills memory, once the pool has a
+//! string of the right size class free.
+//! An oversized datagram is not an error here: a caller reading at an MTU expects to drop one, as an interface would.
+bool UDPSocket::recv(Address &source_address, Buffer &payload, const size_t mtu) {
+    auto storage = BufferPool::allocate(mtu);
+    const size_t recv_len = _recv(source_address, storage->data(), storage->size());
+    if (recv_len > storage->size()) {
+        payload = Buffer{};
+        return false;
+    }
+    payload = Buffer{move(storage), recv_len};
+    return true;
+}
+
 UDPSocket::received_datagram UDPSocket::recv(const size_t mtu) {
     received_datagram ret{{nullptr, 0}, ""};
     recv(ret, mtu);
@@ -166,3 +183,17 @@ void Socket::setsockopt(const int level, const int option, const option_type &op
 // allow local address to be reused sooner, at the cost of some robustness
 //! \note Using `SO_REUSEADDR` may reduce the robustness of your application
 void Socket::set_reuseaddr() { setsockopt(SOL_SOCKET, SO_REUSEADDR, int(true)); }
+
+// leave datagrams too big for the path to be dropped, rather than fragmented
+//! \note `IP_PMTUDISC_PROBE` also ignores the kernel's path MTU estimate, so that a packetization-layer
+//! search (e.g. TCP's, over a TCPOverUDPSocketAdapter) can probe above it
+void Socket::set_dont_fragment() { setsockopt(IPPROTO_IP, IP_MTU_DISCOVER, int(IP_PMTUDISC_PROBE)); }
+
+// the largest IPv4 datagram the route to the peer carries: the interface's MTU, or less if the kernel
+// learned a smaller path MTU
+size_t Socket::path_mtu() const {
+    int mtu = 0;
+    socklen_t len = sizeof(mtu);
+    SystemCall("getsockopt", ::getsockopt(fd_num(), IPPROTO_IP, IP_MTU, &mtu, &len));
+    return mtu;
+}
@@ -45,10 +45,21 @@ class Socket : public FileDescriptor {
 
     //! Allow local address to be reused sooner via [SO_REUSEADDR](\ref man7::socket)
     void set_reuseaddr();
+
+    //! Send IPv4 datagrams with the don't-fragment bit, and never fragment them, via [IP_MTU_DISCOVER](\ref man7::ip)
+    void set_dont_fragment();
+
+    //! Get the MTU of the route to the peer of a connected socket via [IP_MTU](\ref man7::ip)
+    size_t path_mtu() const;
 };
 
 //! A wrapper around [UDP sockets](\ref man7::udp)
 class UDPSocket : public Socket {
+  private:
+    //! Receive a datagram of up to `mtu` bytes to `data`, and the Address of its sender
+    //! \returns the size of the datagram, which is more than `mtu` if it was truncated
+    size_t _recv(Address &source_address, char *data, const size_t mtu);
+
   protected:
     //! \brief Construct from FileDescriptor (used by TCPOverUDPSocketAdapter)
     //! \param[in] fd is the FileDescriptor from which to construct
@@ -70,6 +81,11 @@ class UDPSocket : public Socket {
     //! Receive a datagram and the Address of its sender (caller can allocate storage)
     void recv(received_datagram &datagram, const size_t mtu = 65536);
 
+    //! Receive a datagram into `payload`, drawing its storage from the BufferPool, and the Address of its sender
+    //! \note `mtu` picks the pool's size class, and a datagram as large as the class's strings is received.
+    //! \returns `false`, leaving `payload` empty, if the datagram was larger (and so was truncated)
+    bool recv(Address &source_address, Buffer &payload, const size_t mtu = BufferPool::MAX_SIZE);
+
     //! Send a datagram to specified Address
     void sendto(const Address &destination, const BufferViewList &payload);
 
@@ -7,6 +7,7 @@
 #include <linux/if.h>
 #include <linux/if_tun.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 
 static constexpr const char *CLONEDEV = "/dev/net/tun";
 
@@ -22,7 +23,7 @@ using namespace std;
 //! as root before calling this function.
 
 TunTapFD::TunTapFD(const string &devname, const bool is_tun)
-    : FileDescriptor(SystemCall("open", open(CLONEDEV, O_RDWR))) {
+    : FileDescriptor(SystemCall("open", open(CLONEDEV, O_RDWR))), _mtu() {
     struct ifreq tun_req {};
 
     tun_req.ifr_flags = (is_tun ? IFF_TUN : IFF_TAP) | IFF_NO_PI;  // tun device with no packetinfo
@@ -33,4 +34,9 @@ TunTapFD::TunTapFD(const string &devname, const bool is_tun)
     tun_req.ifr_name[IFNAMSIZ - 1] = '\0';
 
     SystemCall("ioctl", ioctl(fd_num(), TUNSETIFF, static_cast<void *>(&tun_req)));
+
+    // the MTU is an interface setting, so it is read through a socket
+    const FileDescriptor sock{SystemCall("socket", socket(AF_INET, SOCK_DGRAM, 0))};
+    SystemCall("ioctl", ioctl(sock.fd_num(), SIOCGIFMTU, static_cast<void *>(&tun_req)));
+    _mtu = tun_req.ifr_mtu;
 }
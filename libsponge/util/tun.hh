@@ -3,13 +3,21 @@
 
 #include "file_descriptor.hh"
 
+#include <cstddef>
 #include <string>
 
 //! A FileDescriptor to a [Linux TUN/TAP](https://www.kernel.org/doc/Documentation/networking/tuntap.txt) device
 class TunTapFD : public FileDescriptor {
+  private:
+    size_t _mtu;  //!< The device's MTU when it was opened
+
   public:
     //! Open an existing persistent [TUN or TAP device](https://www.kernel.org/doc/Documentation/networking/tuntap.txt).
     explicit TunTapFD(const std::string &devname, const bool is_tun);
+
+    //! The device's MTU, as of when it was opened: the largest IP datagram it carries (a TAP device's frames
+    //! also have an Ethernet header)
+    size_t mtu() const { return _mtu; }
 };
 
 //! A FileDescriptor to a [Linux TUN](https://www.kernel.org/doc/Documentation/networking/tuntap.txt) device
@@ -3,11 +3,17 @@
 #include <array>
 #include <cctype>
 #include <chrono>
+#include <cstring>
+#include <initializer_list>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <sys/socket.h>
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 using namespace std;
 
 //! \returns the number of milliseconds since the program started
@@ -84,21 +90,142 @@ mt19937 get_random_generator() {
 //!
 //! For more information, see the [Wikipedia page](https://en.wikipedia.org/wiki/IPv4_header_checksum)
 //! on the Internet checksum, and consult the [IP](\ref rfc::rfc791) and [TCP](\ref rfc::rfc793) RFCs.
-InternetChecksum::InternetChecksum(const uint32_t initial_sum) : _sum(initial_sum) {}
+InternetChecksum::InternetChecksum(const uint32_t initial_sum, const Kernel kernel)
+    : _sum(initial_sum), _kernel(supported(kernel) ? kernel : Kernel::Scalar) {}
+
+//! \returns the one's-complement sum of the big-endian 16-bit words of `data`, folded to 16 bits
+//! \details The words are loaded in host byte order, eight bytes at a time: the one's-complement sum of
+//! byte-swapped words is the byte-swapped sum (RFC 1071, section 2(B)), so only the
+//! folded result needs swapping.
+//!
+//! With `copy`, each word is also stored to `dest` once it is loaded, so copying costs no second pass.
+template <bool copy>
+static uint64_t sum_words_scalar(const char *data, const size_t len, char *dest) {
+    uint64_t sum = 0;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        if constexpr (copy) {
+            memcpy(dest + i, &word, sizeof(word));
+        }
+        sum += (word & 0xffffffff) + (word >> 32);
+    }
+    for (; i + 2 <= len; i += 2) {
+        uint16_t word;
+        memcpy(&word, data + i, sizeof(word));
+        if constexpr (copy) {
+            memcpy(dest + i, &word, sizeof(word));
+        }
+        sum += word;
+    }
+
+    while (sum > 0xffff) {
+        sum = (sum >> 16) + (sum & 0xffff);
+    }
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    sum = ((sum & 0xff) << 8) | (sum >> 8);
+#endif
+    return sum;
+}
+
+#if defined(__x86_64__)
+// The vector kernels add up the first and second bytes of the words separately, with PSADBW summing
+// eight bytes into each 64-bit lane, so no lane can overflow. The sum of the words is then
+// 256 * (first bytes) + (second bytes).
+
+static uint64_t sum_lanes(const __m128i lanes) {
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(lanes)) +
+           static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(lanes, lanes)));
+}
+
+template <bool copy>
+static uint64_t sum_words_sse2(const char *data, const size_t len, char *dest) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i first_bytes = _mm_set1_epi16(0x00ff);
+    __m128i first = zero, second = zero;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        if constexpr (copy) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), block);
+        }
+        first = _mm_add_epi64(first, _mm_sad_epu8(_mm_and_si128(block, first_bytes), zero));
+        second = _mm_add_epi64(second, _mm_sad_epu8(_mm_srli_epi16(block, 8), zero));
+    }
+    const uint64_t sum = (sum_lanes(first) << 8) + sum_lanes(second);
+    return sum + sum_words_scalar<copy>(data + i, len - i, dest + (copy ? i : 0));
+}
+
+template <bool copy>
+__attribute__((target("avx2"))) static uint64_t sum_words_avx2(const char *data, const size_t len, char *dest) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i first_bytes = _mm256_set1_epi16(0x00ff);
+    __m256i first = zero, second = zero;
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        if constexpr (copy) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + i), block);
+        }
+        first = _mm256_add_epi64(first, _mm256_sad_epu8(_mm256_and_si256(block, first_bytes), zero));
+        second = _mm256_add_epi64(second, _mm256_sad_epu8(_mm256_srli_epi16(block, 8), zero));
+    }
+    const __m128i first_half = _mm_add_epi64(_mm256_castsi256_si128(first), _mm256_extracti128_si256(first, 1));
+    const __m128i second_half = _mm_add_epi64(_mm256_castsi256_si128(second), _mm256_extracti128_si256(second, 1));
+    const uint64_t sum = (sum_lanes(first_half) << 8) + sum_lanes(second_half);
+    // the SSE2 code that sums the rest, and the caller's, would otherwise stall on the dirty upper halves
+    _mm256_zeroupper();
+    return sum + sum_words_sse2<copy>(data + i, len - i, dest + (copy ? i : 0));
+}
+#endif
+
+template <bool copy>
+void InternetChecksum::_add(std::string_view data, char *dest) {
+    if (data.empty()) {
+        return;
+    }
+
+    // a byte left over from the last call is the first of a word, and this call's first byte completes it
+    if (_parity) {
+        _sum += uint8_t(data.front());
+        if constexpr (copy) {
+            *dest++ = data.front();
+        }
+        data.remove_prefix(1);
+        _parity = false;
+    }
+
+    const size_t words_len = data.size() & ~size_t{1};
+    switch (_kernel) {
+#if defined(__x86_64__)
+        case Kernel::AVX2:
+            _sum += sum_words_avx2<copy>(data.data(), words_len, dest);
+            break;
+        case Kernel::SSE2:
+            _sum += sum_words_sse2<copy>(data.data(), words_len, dest);
+            break;
+#endif
+        default:
+            _sum += sum_words_scalar<copy>(data.data(), words_len, dest);
+            break;
+    }
 
-void InternetChecksum::add(std::string_view data) {
-    for (size_t i = 0; i < data.size(); i++) {
-        uint16_t val = uint8_t(data[i]);
-        if (not _parity) {
-            val <<= 8;
+    if (words_len < data.size()) {
+        _sum += uint16_t(uint8_t(data.back()) << 8);
+        if constexpr (copy) {
+            dest[words_len] = data.back();
         }
-        _sum += val;
-        _parity = !_parity;
+        _parity = true;
     }
 }
 
+void InternetChecksum::add(std::string_view data) { _add<false>(data, nullptr); }
+
+void InternetChecksum::copy_and_add(std::string_view data, char *dest) { _add<true>(data, dest); }
+
 uint16_t InternetChecksum::value() const {
-    uint32_t ret = _sum;
+    uint64_t ret = _sum;
 
     while (ret > 0xffff) {
         ret = (ret >> 16) + (ret & 0xffff);
@@ -107,6 +234,48 @@ uint16_t InternetChecksum::value() const {
     return ~ret;
 }
 
+uint16_t InternetChecksum::adjust(const uint16_t cksum, const uint16_t old_value, const uint16_t new_value) {
+    uint32_t sum = uint16_t(~cksum) + uint16_t(~old_value) + new_value;
+
+    while (sum > 0xffff) {
+        sum = (sum >> 16) + (sum & 0xffff);
+    }
+
+    return ~sum;
+}
+
+uint16_t InternetChecksum::adjust(const uint16_t cksum, const uint32_t old_value, const uint32_t new_value) {
+    const uint16_t high = adjust(cksum, uint16_t(old_value >> 16), uint16_t(new_value >> 16));
+    return adjust(high, uint16_t(old_value & 0xffff), uint16_t(new_value & 0xffff));
+}
+
+bool InternetChecksum::supported(const Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return true;
+#if defined(__x86_64__)
+        case Kernel::SSE2:
+            return true;
+        case Kernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+InternetChecksum::Kernel InternetChecksum::fastest_kernel() {
+    static const Kernel fastest = [] {
+        for (const Kernel kernel : {Kernel::AVX2, Kernel::SSE2}) {
+            if (supported(kernel)) {
+                return kernel;
+            }
+        }
+        return Kernel::Scalar;
+    }();
+    return fastest;
+}
+
 //! \param[in] data is a pointer to the bytes to show
 //! \param[in] len is the number of bytes to show
 //! \param[in] indent is the number of spaces to indent
@@ -53,14 +53,48 @@ uint64_t timestamp_ms();
 
 //! The internet checksum algorithm
 class InternetChecksum {
+  public:
+    //! How add() sums the data: all give the same checksum, whatever the lengths of the pieces added
+    enum class Kernel {
+        Scalar,  //!< eight bytes at a time, in a 64-bit accumulator
+        SSE2,    //!< 16 bytes at a time (x86-64 only)
+        AVX2     //!< 32 bytes at a time (x86-64 CPUs that support it)
+    };
+
   private:
-    uint32_t _sum;
-    bool _parity{};
+    uint64_t _sum;
+    bool _parity{};  //!< whether the last byte added was the first of a 16-bit word
+    Kernel _kernel;
+
+    //! Add `data`, copying it to `dest` as it goes if `copy` is set
+    template <bool copy>
+    void _add(std::string_view data, char *dest);
 
   public:
-    InternetChecksum(const uint32_t initial_sum = 0);
+    //! \param[in] initial_sum is a sum to start from (e.g., of a pseudo-header)
+    //! \param[in] kernel is how to sum the data; an unsupported kernel falls back to Kernel::Scalar
+    InternetChecksum(const uint32_t initial_sum = 0, const Kernel kernel = fastest_kernel());
     void add(std::string_view data);
+
+    //! \brief Add `data` while copying it to `dest` (which must have room for `data.size()` bytes)
+    //! \details The bytes are summed as they are copied, so checksumming costs no second pass over them.
+    void copy_and_add(std::string_view data, char *dest);
+
     uint16_t value() const;
+
+    //! \brief Adjust a checksum for a 16-bit word of the data changing from `old_value` to `new_value`
+    //! \details RFC 1624 eqn. 3, HC' = ~(~HC + ~m + m'): no other byte of the data is read, and the result
+    //! is the checksum that summing the changed data would give.
+    static uint16_t adjust(const uint16_t cksum, const uint16_t old_value, const uint16_t new_value);
+
+    //! \brief Adjust a checksum for a 32-bit field (two adjacent 16-bit words) of the data changing
+    static uint16_t adjust(const uint16_t cksum, const uint32_t old_value, const uint32_t new_value);
+
+    //! \returns whether this build and this CPU can use `kernel`
+    static bool supported(const Kernel kernel);
+
+    //! \returns the fastest supported kernel, as detected when first called
+    static Kernel fastest_kernel();
 };
 
 //! Hexdump the contents of a packet (or any other sequence of bytes)
@@ -0,0 +1,144 @@
+#include "address.hh"
+#include "buffer.hh"
+#include "file_descriptor.hh"
+#include "socket.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        // strings come in size classes, except those too big for any
+        for (const auto &[size, expected] : vector<pair<size_t, size_t>>{
+                 {0, 2048}, {1500, 2048}, {2049, 9216}, {9000, 9216}, {65536, 65536}, {70000, 70000}}) {
+            if (BufferPool::allocate(size)->size() != expected) {
+                throw runtime_error("allocated " + to_string(size) + " bytes in the wrong size class");
+            }
+        }
+
+        // a string is recycled once the last Buffer sharing it is gone
+        {
+            auto storage = BufferPool::allocate(1500);
+            const string *const first = storage.get();
+            const size_t free_before = BufferPool::free_count(1500);
+            Buffer buffer{move(storage), 100};
+            Buffer slice = buffer;
+            slice.remove_prefix(50);
+            buffer = Buffer{};
+            if (BufferPool::free_count(1500) != free_before) {
+                throw runtime_error("string recycled while a slice still used it");
+            }
+            slice = Buffer{};
+            if (BufferPool::free_count(1500) != free_before + 1 or BufferPool::allocate(1000).get() != first) {
+                throw runtime_error("string not recycled");
+            }
+        }
+
+        // each thread keeps only so many free strings of a class
+        {
+            vector<shared_ptr<string>> strings;
+            for (size_t i = 0; i < BufferPool::MAX_FREE_BYTES / BufferPool::MAX_SIZE + 10; ++i) {
+                strings.push_back(BufferPool::allocate(BufferPool::MAX_SIZE));
+            }
+            strings.clear();
+            if (BufferPool::free_count(BufferPool::MAX_SIZE) != BufferPool::MAX_FREE_BYTES / BufferPool::MAX_SIZE) {
+                throw runtime_error("too many free strings kept");
+            }
+        }
+
+        // a string goes back to the free list of the thread that drops it, even after its own thread is gone
+        {
+            const size_t free_before = BufferPool::free_count(9000);
+            Buffer from_thread;
+            thread([&] { from_thread = Buffer{BufferPool::allocate(9000), 9000}; }).join();
+            size_t free_in_thread = 0;
+            thread([&] {
+                from_thread = Buffer{};
+                free_in_thread = BufferPool::free_count(9000);
+            }).join();
+            if (free_in_thread != 1 or BufferPool::free_count(9000) != free_before) {
+                throw runtime_error("string went back to the wrong thread's free list");
+            }
+        }
+
+        // a packet buffer draws its storage from the pool, and hands it to a Buffer
+        {
+            PacketBuffer packet{1460};
+            const char *const payload = packet.put(1460);
+            packet.push(40);
+            const Buffer buffer = packet.release();
+            if (buffer.size() != 1500 or buffer.str().data() + 40 != payload) {
+                throw runtime_error("packet buffer did not become a Buffer without a copy");
+            }
+        }
+
+        // reading a file descriptor into a Buffer
+        {
+            int fds[2];
+            SystemCall("pipe", ::pipe(fds));
+            FileDescriptor read_end{fds[0]}, write_end{fds[1]};
+            write_end.write("hello");
+            Buffer buffer;
+            read_end.read(buffer);
+            if (buffer.str() != "hello") {
+                throw runtime_error("read the wrong bytes into a Buffer");
+            }
+            write_end.close();
+            read_end.read(buffer);
+            if (buffer.size() != 0 or not read_end.eof()) {
+                throw runtime_error("reading a Buffer missed EOF");
+            }
+        }
+
+        // and receiving a datagram into one
+        {
+            UDPSocket receiver, sender;
+            receiver.bind(Address("127.0.0.1", 0));
+            sender.bind(Address("127.0.0.1", 0));
+            sender.sendto(receiver.local_address(), "hi there");
+            Address source{nullptr, 0};
+            Buffer payload;
+            receiver.recv(source, payload);
+            if (payload.str() != "hi there" or source != sender.local_address()) {
+                throw runtime_error("received the wrong datagram into a Buffer");
+            }
+        }
+
+        // receiving at the MTU of the route to the sender: a datagram as large as the size class fits
+        {
+            UDPSocket receiver, route;
+            receiver.bind(Address("127.0.0.1", 0));
+            route.connect(receiver.local_address());
+            if (route.path_mtu() < 576 or route.path_mtu() > BufferPool::MAX_SIZE) {
+                throw runtime_error("implausible path MTU " + to_string(route.path_mtu()));
+            }
+            route.sendto(receiver.local_address(), string(2000, 'x'));
+            Address source{nullptr, 0};
+            Buffer payload;
+            receiver.recv(source, payload, 1500);
+            if (payload.size() != 2000) {
+                throw runtime_error("datagram larger than the MTU but within its size class was not received");
+            }
+            route.sendto(receiver.local_address(), string(3000, 'x'));
+            if (receiver.recv(source, payload, 1500) or payload.size() != 0) {
+                throw runtime_error("datagram larger than the size class was not dropped");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
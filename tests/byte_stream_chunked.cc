@@ -0,0 +1,80 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            ByteStreamTestHarness test{"chunked write-write-pop across chunks", 15, ByteStream::Storage::Chunked};
+
+            test.execute(Write{"cat"});
+            test.execute(Write{"tac"});
+            test.execute(BytesWritten{6});
+            test.execute(RemainingCapacity{9});
+            test.execute(BufferSize{6});
+            test.execute(Peek{"cattac"});
+
+            test.execute(Pop{4});
+
+            test.execute(BytesRead{4});
+            test.execute(RemainingCapacity{13});
+            test.execute(BufferSize{2});
+            test.execute(Peek{"ac"});
+
+            test.execute(EndInput{});
+            test.execute(Pop{2});
+
+            test.execute(BufferEmpty{true});
+            test.execute(Eof{true});
+        }
+
+        {
+            ByteStreamTestHarness test{"chunked overwrite", 2, ByteStream::Storage::Chunked};
+
+            test.execute(Write{"cat"}.with_bytes_written(2));
+            test.execute(Peek{"ca"});
+            test.execute(Pop{1});
+            test.execute(Write{"tac"}.with_bytes_written(1));
+            test.execute(RemainingCapacity{0});
+            test.execute(Peek{"at"});
+        }
+
+        {
+            ByteStream stream{65536, ByteStream::Storage::Chunked};
+            const string data(4000, 'x');
+            stream.write(data);
+            stream.write("tail");
+
+            const Buffer first = stream.read_buffer(1000);
+            const Buffer second = stream.read_buffer(1000);
+            if (first.size() != 1000 or second.size() != 1000) {
+                throw runtime_error("read_buffer returned the wrong number of bytes");
+            }
+            if (first.str().data() + 1000 != second.str().data()) {
+                throw runtime_error("read_buffer copied bytes that lie within one chunk");
+            }
+
+            const BufferList rest = stream.peek_buffers(3000);
+            if (rest.buffers().size() != 2 or rest.size() != 2004 or rest.concatenate() != string(2000, 'x') + "tail") {
+                throw runtime_error("peek_buffers did not return slices of the written chunks");
+            }
+            if (rest.buffers().front().str().data() != second.str().data() + 1000) {
+                throw runtime_error("peek_buffers copied bytes that lie within one chunk");
+            }
+
+            const Buffer spanning = stream.read_buffer(2002);
+            if (spanning.str() != string(2000, 'x') + "ta" or stream.peek_output(10) != "il") {
+                throw runtime_error("read_buffer across chunks returned the wrong bytes");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
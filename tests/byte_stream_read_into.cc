@@ -0,0 +1,59 @@
+#include "byte_stream.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+static string concatenate(const vector<iovec> &iovecs) {
+    string ret;
+    for (const auto &iov : iovecs) {
+        ret.append(static_cast<const char *>(iov.iov_base), iov.iov_len);
+    }
+    return ret;
+}
+
+int main() {
+    try {
+        for (const auto storage : {ByteStream::Storage::Ring, ByteStream::Storage::Chunked}) {
+            const string name = storage == ByteStream::Storage::Ring ? "ring" : "chunked";
+            ByteStream stream{8, storage};
+            char dest[16]{};
+
+            // leave the ring's head at 4 so the next write wraps around
+            stream.write("abcdef");
+            if (stream.read_into(dest, 4) != 4 or string(dest, 4) != "abcd") {
+                throw runtime_error(name + ": read_into returned the wrong bytes");
+            }
+            stream.write("ghijkl");
+
+            if (stream.peek_into(dest, 16) != 8 or string(dest, 8) != "efghijkl") {
+                throw runtime_error(name + ": peek_into across the wrap returned the wrong bytes");
+            }
+            if (stream.buffer_size() != 8) {
+                throw runtime_error(name + ": peek_into popped bytes");
+            }
+
+            const auto views = stream.peek_views(6);
+            if (views.size() != 6 or concatenate(views.as_iovecs()) != "efghij") {
+                throw runtime_error(name + ": peek_views returned the wrong bytes");
+            }
+            const auto iovecs = stream.peek_iovecs(16);
+            if (iovecs.size() != 2 or concatenate(iovecs) != "efghijkl") {
+                throw runtime_error(name + ": peek_iovecs did not expose the two regions");
+            }
+
+            if (stream.read_into(dest, 4) != 4 or string(dest, 4) != "efgh" or stream.bytes_read() != 8) {
+                throw runtime_error(name + ": read_into did not pop what it copied");
+            }
+            if (stream.peek_views(16).size() != 4 or stream.peek_views(0).size() != 0) {
+                throw runtime_error(name + ": peek_views returned the wrong length");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
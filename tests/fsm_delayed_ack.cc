@@ -0,0 +1,126 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const WrappingInt32 isn{0};
+
+//! Move `from`'s segments to `to`, through serialization as on the wire, except those numbered in `drop`
+//! \returns the segments, as parsed
+static vector<TCPSegment> transfer(TCPConnection &from, TCPConnection &to, const set<size_t> &drop = {}) {
+    vector<TCPSegment> ret;
+    for (size_t i = 0; not from.segments_out().empty(); ++i) {
+        TCPSegment seg;
+        if (const auto res = seg.parse(from.segments_out().front().serialize().concatenate());
+            res != ParseResult::NoError) {
+            throw runtime_error("could not parse a segment: " + as_string(res));
+        }
+        from.segments_out().pop();
+        if (drop.count(i) == 0) {
+            to.segment_received(seg);
+        }
+        ret.push_back(seg);
+    }
+    return ret;
+}
+
+//! A client and server that have finished the handshake, the server acknowledging every two segments
+struct Connected {
+    TCPConnection client, server;
+
+    Connected() : client{config()}, server{config()} {
+        client.connect();
+        transfer(client, server);
+        transfer(server, client);
+        transfer(client, server);
+    }
+
+    static TCPConfig config() {
+        TCPConfig cfg;
+        cfg.fixed_isn = isn;
+        cfg.delayed_ack_segments = 2;
+        return cfg;
+    }
+};
+
+static void expect_acks(const vector<TCPSegment> &acks, const vector<uint64_t> &acknos, const string &when) {
+    bool ok = acks.size() == acknos.size();
+    for (size_t i = 0; ok and i < acks.size(); ++i) {
+        ok = acks[i].header().ack and acks[i].header().ackno == wrap(acknos[i], isn);
+    }
+    if (not ok) {
+        throw runtime_error("sent " + to_string(acks.size()) + " segments, not the expected ACKs, " + when);
+    }
+}
+
+int main() {
+    try {
+        // in-order data is acknowledged every second segment
+        {
+            Connected c;
+            c.client.write(string(4000, 'x'));
+            transfer(c.client, c.server);
+            expect_acks(transfer(c.server, c.client), {2001, 4001}, "for four segments in order");
+        }
+
+        // an acknowledgment waits no longer than the timeout
+        {
+            Connected c;
+            c.client.write(string(1000, 'x'));
+            transfer(c.client, c.server);
+            c.server.tick(Connected::config().delayed_ack_timeout - 1);
+            expect_acks(transfer(c.server, c.client), {}, "before the timeout");
+            c.server.tick(1);
+            expect_acks(transfer(c.server, c.client), {1001}, "at the timeout");
+        }
+
+        // out-of-order data, and the segment that fills the hole, are acknowledged at once
+        {
+            Connected c;
+            c.client.write(string(3000, 'x'));
+            transfer(c.client, c.server, {0});
+            expect_acks(transfer(c.server, c.client), {1, 1}, "for segments after a hole");
+            c.client.tick(TCPConfig::TIMEOUT_DFLT);
+            transfer(c.client, c.server);
+            expect_acks(transfer(c.server, c.client), {3001}, "for the segment filling the hole");
+        }
+
+        // so is a FIN
+        {
+            Connected c;
+            c.client.end_input_stream();
+            transfer(c.client, c.server);
+            expect_acks(transfer(c.server, c.client), {2}, "for a FIN");
+        }
+
+        // data of our own carries the acknowledgment, and nothing is sent when the timeout would have expired
+        {
+            Connected c;
+            c.client.write(string(1000, 'x'));
+            transfer(c.client, c.server);
+            c.server.write("reply");
+            const vector<TCPSegment> reply = transfer(c.server, c.client);
+            expect_acks(reply, {1001}, "with a reply");
+            if (reply.front().payload().size() != 5) {
+                throw runtime_error("reply did not carry the data");
+            }
+            c.server.tick(Connected::config().delayed_ack_timeout);
+            expect_acks(transfer(c.server, c.client), {}, "after a reply carried the acknowledgment");
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+#include "stream_reassembler.hh"
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static const WrappingInt32 isn{0};
+
+//! Move `from`'s segments to `to`, through serialization as on the wire, except those numbered in `drop`
+//! \returns the segments, as parsed
+static vector<TCPSegment> transfer(TCPConnection &from, TCPConnection &to, const set<size_t> &drop = {}) {
+    vector<TCPSegment> ret;
+    for (size_t i = 0; not from.segments_out().empty(); ++i) {
+        TCPSegment seg;
+        if (const auto res = seg.parse(from.segments_out().front().serialize().concatenate());
+            res != ParseResult::NoError) {
+            throw runtime_error("could not parse a segment: " + as_string(res));
+        }
+        from.segments_out().pop();
+        if (drop.count(i) == 0) {
+            to.segment_received(seg);
+        }
+        ret.push_back(seg);
+    }
+    return ret;
+}
+
+static TCPConfig config(const bool sack) {
+    TCPConfig cfg;
+    cfg.fixed_isn = isn;
+    cfg.fast_retransmit = true;
+    cfg.sack = sack;
+    return cfg;
+}
+
+static void expect_blocks(const TCPSegment &seg, const vector<pair<uint64_t, uint64_t>> &blocks, const string &when) {
+    const TCPOptions &options = seg.header().options;
+    bool ok = options.sack_block_count == blocks.size();
+    for (size_t i = 0; ok and i < blocks.size(); ++i) {
+        ok = options.sack_blocks[i].left == wrap(blocks[i].first, isn) and
+             options.sack_blocks[i].right == wrap(blocks[i].second, isn);
+    }
+    if (not ok) {
+        throw runtime_error("wrong SACK blocks " + when + ":" + options.to_string());
+    }
+}
+
+static void expect_retransmission(const vector<TCPSegment> &segments, const uint64_t seqno, const string &when) {
+    if (segments.size() != 1 or segments.front().header().seqno != wrap(seqno, isn)) {
+        throw runtime_error("did not retransmit just the segment at " + to_string(seqno) + " " + when);
+    }
+}
+
+int main() {
+    try {
+        // the reassembler reports the same runs of stored bytes whichever engine holds them
+        for (const auto engine : {StreamReassembler::Engine::Map, StreamReassembler::Engine::Bitmap}) {
+            StreamReassembler reassembler{100, engine};
+            reassembler.push_substring("cd", 2, false);
+            reassembler.push_substring("e", 4, false);
+            reassembler.push_substring("gh", 6, false);
+            reassembler.push_substring("hij", 7, false);
+            using Run = optional<pair<size_t, size_t>>;
+            if (reassembler.unassembled_run(0) != Run{{2, 5}} or reassembler.unassembled_run(5) != Run{{6, 10}} or
+                reassembler.unassembled_run(10).has_value()) {
+                throw runtime_error("reassembler reported the wrong runs");
+            }
+        }
+
+        // SACK is used only when both SYNs permit it
+        for (const auto &[client_offers, server_offers] : {pair{true, true}, pair{true, false}, pair{false, true}}) {
+            TCPConnection client{config(client_offers)}, server{config(server_offers)};
+            client.connect();
+            const vector<TCPSegment> syn = transfer(client, server);
+            const vector<TCPSegment> syn_ack = transfer(server, client);
+            const bool agreed = client_offers and server_offers;
+            if (syn.size() != 1 or syn.front().header().options.sack_permitted != client_offers or
+                syn_ack.size() != 1 or syn_ack.front().header().options.sack_permitted != agreed) {
+                throw runtime_error("SYNs offered SACK when they should not have");
+            }
+            transfer(client, server);
+
+            // with one segment missing, the receiver's ACKs carry SACK blocks only if SACK was agreed
+            client.write(string(3000, 'x'));
+            transfer(client, server, {0});
+            const vector<TCPSegment> acks = transfer(server, client);
+            if (acks.empty() or (acks.back().header().options.sack_block_count > 0) != agreed) {
+                throw runtime_error("ACK carried SACK blocks when it should not have");
+            }
+        }
+
+        // two holes in one window: the most recently received block is reported first, and both holes
+        // are repaired without waiting for a timeout
+        {
+            TCPConnection client{config(true)}, server{config(true)};
+            client.connect();
+            transfer(client, server);
+            transfer(server, client);
+            transfer(client, server);
+
+            client.write(string(5000, 'x'));
+            transfer(client, server, {0, 2});
+            const vector<TCPSegment> acks = transfer(server, client);
+            if (acks.size() != 3) {
+                throw runtime_error("receiver did not acknowledge each segment");
+            }
+            expect_blocks(acks[0], {{1001, 2001}}, "after the second segment");
+            expect_blocks(acks[1], {{3001, 4001}, {1001, 2001}}, "after the fourth segment");
+            expect_blocks(acks[2], {{3001, 5001}, {1001, 2001}}, "after the fifth segment");
+
+            expect_retransmission(transfer(client, server), 1, "after three segments were SACKed");
+            const vector<TCPSegment> partial = transfer(server, client);
+            if (partial.size() != 1 or partial.front().header().ackno != wrap(2001, isn)) {
+                throw runtime_error("repaired hole was not acknowledged");
+            }
+            expect_blocks(partial.front(), {{3001, 5001}}, "after the first hole was repaired");
+
+            expect_retransmission(transfer(client, server), 2001, "on a partial ACK");
+            const vector<TCPSegment> last = transfer(server, client);
+            if (last.size() != 1 or last.front().header().ackno != wrap(5001, isn)) {
+                throw runtime_error("repaired holes were not acknowledged");
+            }
+            expect_blocks(last.front(), {}, "once nothing was missing");
+            if (client.bytes_in_flight() != 0 or server.inbound_stream().buffer_size() != 5000) {
+                throw runtime_error("data was not delivered");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include "byte_stream.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr unsigned NREPS = 32;
+static constexpr unsigned NSEGS = 4096;
+static constexpr unsigned MAX_SEG_LEN = 300;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // in-order substrings take the fast path; gaps and overlaps with stored bytes do not
+        for (const auto engine : {StreamReassembler::Engine::Map, StreamReassembler::Engine::Bitmap}) {
+            StreamReassembler buf{64, engine};
+            buf.push_substring("abc", 0, false);
+            buf.push_substring("ghi", 6, false);
+            buf.push_substring("defgh", 3, false);
+            buf.push_substring("ab", 0, false);
+            buf.push_substring("jk", 9, false);
+            if (buf.stream_out().read(11) != "abcdefghijk" or buf.unassembled_bytes() != 0) {
+                throw runtime_error("reassembled bytes are incorrect");
+            }
+            const size_t expected_fast = engine == StreamReassembler::Engine::Bitmap ? 3 : 2;
+            if (buf.fast_path_hits() != expected_fast or buf.slow_path_hits() != 4 - expected_fast) {
+                throw runtime_error("fast/slow path counters are incorrect");
+            }
+        }
+
+        // random overlapping, duplicated and out-of-window segments, with the output read a bit at
+        // a time: the bitmap engine must behave exactly like the map engine
+        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
+            // not a multiple of 64, so runs wrap around the ring mid-word
+            const size_t capacity = 1000 + rd() % 1000;
+            StreamReassembler map{capacity, StreamReassembler::Engine::Map};
+            StreamReassembler bitmap{capacity, StreamReassembler::Engine::Bitmap};
+
+            const size_t total = 64 * capacity;
+            string d(total, 0);
+            generate(d.begin(), d.end(), [&] { return rd(); });
+
+            for (unsigned i = 0; i < NSEGS and not map.stream_out().eof(); ++i) {
+                const size_t index = min(total - 1, map.first_unassembled() + rd() % (capacity + capacity / 4));
+                const size_t len = min(total - index, size_t(rd() % MAX_SEG_LEN));
+                const bool eof = index + len == total;
+                map.push_substring(d.substr(index, len), index, eof);
+                bitmap.push_substring(d.substr(index, len), index, eof);
+
+                if (map.unassembled_bytes() != bitmap.unassembled_bytes()) {
+                    throw runtime_error("unassembled_bytes() differs between engines");
+                }
+                if (map.stream_out().buffer_size() != bitmap.stream_out().buffer_size()) {
+                    throw runtime_error("number of assembled bytes differs between engines");
+                }
+                if (rd() % 4 == 0) {
+                    const size_t read_len = rd() % (map.stream_out().buffer_size() + 1);
+                    const size_t read_index = map.stream_out().bytes_read();
+                    const string expected = d.substr(read_index, read_len);
+                    if (map.stream_out().read(read_len) != expected or bitmap.stream_out().read(read_len) != expected) {
+                        throw runtime_error("content of assembled bytes is incorrect");
+                    }
+                }
+            }
+
+            // fill in everything that is left, in order
+            while (not map.stream_out().eof()) {
+                const size_t index = map.first_unassembled();
+                const size_t len = min(total - index, map.first_unacceptable() - index);
+                map.push_substring(d.substr(index, len), index, index + len == total);
+                bitmap.push_substring(d.substr(index, len), index, index + len == total);
+
+                const size_t read_index = map.stream_out().bytes_read();
+                const string expected = d.substr(read_index, map.stream_out().buffer_size());
+                if (map.stream_out().read(expected.size()) != expected or
+                    bitmap.stream_out().read(expected.size()) != expected) {
+                    throw runtime_error("content of assembled bytes is incorrect after filling in");
+                }
+            }
+            if (not bitmap.stream_out().eof() or not bitmap.empty()) {
+                throw runtime_error("bitmap engine did not reach eof");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+#include "buffer.hh"
+#include "byte_stream.hh"
+#include "stream_reassembler.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        // Buffers pushed in order, out of order and overlapping reach a chunked output without a copy
+        {
+            StreamReassembler buf{64, StreamReassembler::Engine::Map, ByteStream::Storage::Chunked};
+            const Buffer first{string("abcd")};
+            const Buffer second{string("cdefgh")};
+            const Buffer third{string("ijkl")};
+
+            buf.push_substring(first, 0, false);
+            buf.push_substring(third, 8, true);
+            if (buf.unassembled_bytes() != 4 or buf.stream_out().buffer_size() != 4) {
+                throw runtime_error("out-of-order Buffer was not stored");
+            }
+            buf.push_substring(second, 2, false);
+
+            if (not buf.stream_out().input_ended() or buf.unassembled_bytes() != 0) {
+                throw runtime_error("Buffers were not fully assembled");
+            }
+            if (buf.stream_out().bytes_copied() != 0) {
+                throw runtime_error("Buffers were copied on their way to a chunked output");
+            }
+
+            const Buffer a = buf.stream_out().read_buffer(4);
+            const Buffer e = buf.stream_out().read_buffer(4);
+            const Buffer i = buf.stream_out().read_buffer(4);
+            if (a.str() != "abcd" or e.str() != "efgh" or i.str() != "ijkl") {
+                throw runtime_error("reassembled bytes are incorrect");
+            }
+            if (a.str().data() != first.str().data() or e.str().data() != second.str().data() + 2 or
+                i.str().data() != third.str().data()) {
+                throw runtime_error("reassembled bytes are not slices of the pushed Buffers");
+            }
+            if (not buf.stream_out().eof()) {
+                throw runtime_error("stream did not reach eof");
+            }
+        }
+
+        // a Buffer covering little of its storage is copied out of it before being stored out of order, so as
+        // not to pin it all; in order, it goes to the output as it is
+        {
+            StreamReassembler buf{4096, StreamReassembler::Engine::Map, ByteStream::Storage::Chunked};
+            Buffer small{string(BufferPool::MAX_SIZE, 'x')};
+            small.remove_suffix(small.size() - 100);
+            Buffer large{BufferPool::allocate(1500), 1500};
+
+            buf.push_substring(small, 1500, false);
+            buf.push_substring(large, 0, false);
+            const Buffer first = buf.stream_out().read_buffer(1500);
+            const Buffer second = buf.stream_out().read_buffer(100);
+            if (first.str().data() != large.str().data()) {
+                throw runtime_error("Buffer covering most of its storage was copied");
+            }
+            if (second.str() != small.str() or second.str().data() == small.str().data()) {
+                throw runtime_error("Buffer covering little of its storage was kept as a slice");
+            }
+            if (buf.stream_out().bytes_copied() != 100) {
+                throw runtime_error("copy of a stored Buffer was not counted");
+            }
+
+            buf.push_substring(small, 1600, false);
+            if (buf.stream_out().read_buffer(100).str().data() != small.str().data()) {
+                throw runtime_error("in-order Buffer was copied");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -126,6 +126,26 @@ int main() {
             test.execute(UnassembledBytes(0));
         }
 
+        {
+            // Submission filling the gaps between several unassembled sections
+            const size_t cap = {1000};
+            ReassemblerTestHarness test{cap};
+
+            test.execute(SubmitSegment{"b", 1});
+            test.execute(SubmitSegment{"de", 3});
+            test.execute(SubmitSegment{"h", 7});
+            test.execute(UnassembledBytes(4));
+
+            test.execute(SubmitSegment{"bcdefg", 1});
+            test.execute(BytesAvailable(""));
+            test.execute(UnassembledBytes(7));
+
+            test.execute(SubmitSegment{"a", 0});
+            test.execute(BytesAvailable("abcdefgh"));
+            test.execute(BytesAssembled(8));
+            test.execute(UnassembledBytes(0));
+        }
+
     } catch (const exception &e) {
         cerr << "Exception: " << e.what() << endl;
         return EXIT_FAILURE;
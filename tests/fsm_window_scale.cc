@@ -0,0 +1,112 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! Move `from`'s segments to `to`, through serialization as on the wire
+//! \returns the segments, as parsed
+static vector<TCPSegment> transfer(TCPConnection &from, TCPConnection &to) {
+    vector<TCPSegment> ret;
+    while (not from.segments_out().empty()) {
+        TCPSegment seg;
+        if (const auto res = seg.parse(from.segments_out().front().serialize().concatenate());
+            res != ParseResult::NoError) {
+            throw runtime_error("could not parse a segment: " + as_string(res));
+        }
+        from.segments_out().pop();
+        to.segment_received(seg);
+        ret.push_back(seg);
+    }
+    return ret;
+}
+
+static const TCPHeader &only_header(const vector<TCPSegment> &segments, const string &what) {
+    if (segments.size() != 1) {
+        throw runtime_error("expected just the " + what + ", got " + to_string(segments.size()) + " segments");
+    }
+    return segments.front().header();
+}
+
+static TCPConfig config(const size_t capacity, const bool window_scaling) {
+    TCPConfig cfg;
+    cfg.recv_capacity = capacity;
+    cfg.send_capacity = capacity;
+    cfg.window_scaling = window_scaling;
+    return cfg;
+}
+
+int main() {
+    try {
+        // both ends offer the option: windows after the SYNs are scaled, and the sender fills a window of 1 MB
+        {
+            TCPConnection client{config(1'000'000, true)}, server{config(1'000'000, true)};
+            client.connect();
+            const TCPHeader syn = only_header(transfer(client, server), "SYN");
+            if (syn.options.window_scale != 4 or syn.win != 65535) {
+                throw runtime_error("SYN did not offer a shift of 4 with an unscaled window");
+            }
+            const TCPHeader syn_ack = only_header(transfer(server, client), "SYN-ACK");
+            if (syn_ack.options.window_scale != 4 or syn_ack.win != 65535) {
+                throw runtime_error("SYN-ACK did not offer a shift of 4 with an unscaled window");
+            }
+
+            // the window in the SYN-ACK is not scaled, so the first flight still fits in 64 kB
+            client.write(string(500'000, 'x'));
+            transfer(client, server);
+            if (client.bytes_in_flight() != 65535) {
+                throw runtime_error("sender did not keep to the SYN-ACK's window");
+            }
+            const vector<TCPSegment> acks = transfer(server, client);
+            if (acks.empty() or acks.back().header().win != (1'000'000 - 65535) >> 4 or
+                acks.back().header().options.window_scale.has_value()) {
+                throw runtime_error("receiver did not advertise a scaled window");
+            }
+            if (client.bytes_in_flight() != 500'000 - 65535) {
+                throw runtime_error("sender did not use the scaled window");
+            }
+            transfer(client, server);
+            transfer(server, client);
+            if (client.bytes_in_flight() != 0 or server.inbound_stream().buffer_size() != 500'000) {
+                throw runtime_error("data was not delivered");
+            }
+        }
+
+        // only one end offers it: nothing is scaled, and the window stays below 64 kB
+        for (const bool client_offers : {true, false}) {
+            TCPConnection client{config(1'000'000, client_offers)}, server{config(1'000'000, not client_offers)};
+            client.connect();
+            const TCPHeader syn = only_header(transfer(client, server), "SYN");
+            if (syn.options.window_scale.has_value() != client_offers) {
+                throw runtime_error("SYN offered window scaling when it should not have");
+            }
+            const TCPHeader syn_ack = only_header(transfer(server, client), "SYN-ACK");
+            if (syn_ack.options.window_scale.has_value()) {
+                throw runtime_error("SYN-ACK offered window scaling without an offer from the SYN");
+            }
+
+            client.write(string(500'000, 'x'));
+            transfer(client, server);
+            if (client.bytes_in_flight() != 65535) {
+                throw runtime_error("sender did not keep to the unscaled window");
+            }
+            const vector<TCPSegment> acks = transfer(server, client);
+            if (acks.empty() or acks.back().header().win != 65535) {
+                throw runtime_error("receiver did not advertise an unscaled window");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+using Kernel = InternetChecksum::Kernel;
+
+//! The checksum computed a byte at a time, as the definition has it
+static uint16_t reference_checksum(const string_view data, const uint32_t initial_sum = 0) {
+    uint64_t sum = initial_sum;
+    for (size_t i = 0; i < data.size(); ++i) {
+        sum += i % 2 == 0 ? uint8_t(data[i]) << 8 : uint8_t(data[i]);
+    }
+    while (sum > 0xffff) {
+        sum = (sum >> 16) + (sum & 0xffff);
+    }
+    return ~sum;
+}
+
+//! The checksum with `kernel`, adding `data` in pieces that end at each of `splits`
+static uint16_t checksum(const Kernel kernel,
+                         const string_view data,
+                         const vector<size_t> &splits,
+                         const uint32_t initial_sum = 0) {
+    InternetChecksum check{initial_sum, kernel};
+    size_t start = 0;
+    for (const size_t split : splits) {
+        check.add(data.substr(start, split - start));
+        start = split;
+    }
+    check.add(data.substr(start));
+    return check.value();
+}
+
+static string kernel_name(const Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return "scalar";
+        case Kernel::SSE2:
+            return "SSE2";
+        case Kernel::AVX2:
+            return "AVX2";
+    }
+    return "unknown";
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        vector<Kernel> kernels;
+        for (const auto kernel : {Kernel::Scalar, Kernel::SSE2, Kernel::AVX2}) {
+            if (InternetChecksum::supported(kernel)) {
+                kernels.push_back(kernel);
+            }
+        }
+        if (not InternetChecksum::supported(InternetChecksum::fastest_kernel())) {
+            throw runtime_error("the fastest kernel is not supported");
+        }
+
+        // every length around the vector widths, at every alignment, in one piece
+        string random_bytes(70000, 0);
+        for (auto &byte : random_bytes) {
+            byte = char(rd());
+        }
+        for (const auto kernel : kernels) {
+            for (size_t offset = 0; offset < 32; ++offset) {
+                for (size_t len = 0; len <= 200; ++len) {
+                    const string_view data = string_view{random_bytes}.substr(offset, len);
+                    if (checksum(kernel, data, {}) != reference_checksum(data)) {
+                        throw runtime_error(kernel_name(kernel) + " kernel got the wrong checksum for " +
+                                            to_string(len) + " bytes at offset " + to_string(offset));
+                    }
+                }
+            }
+        }
+
+        // data added in pieces of odd and even lengths, after an initial sum, has the checksum of the whole
+        for (const auto kernel : kernels) {
+            for (size_t trial = 0; trial < 1000; ++trial) {
+                const size_t len = uniform_int_distribution<size_t>{0, 66000}(rd);
+                const string_view data = string_view{random_bytes}.substr(rd() % 32, len);
+                vector<size_t> splits(uniform_int_distribution<size_t>{0, 5}(rd));
+                for (auto &split : splits) {
+                    split = uniform_int_distribution<size_t>{0, len}(rd);
+                }
+                sort(splits.begin(), splits.end());
+                const uint32_t initial_sum = rd() % 0x40000;
+                if (checksum(kernel, data, splits, initial_sum) != reference_checksum(data, initial_sum)) {
+                    throw runtime_error(kernel_name(kernel) + " kernel got the wrong checksum for " +
+                                        to_string(len) + " bytes in " + to_string(splits.size() + 1) + " pieces");
+                }
+            }
+        }
+
+        // copying while summing gives the same checksum, and copies every byte, whatever the pieces
+        for (const auto kernel : kernels) {
+            for (size_t trial = 0; trial < 200; ++trial) {
+                const size_t len = uniform_int_distribution<size_t>{0, 3000}(rd);
+                const string_view data = string_view{random_bytes}.substr(rd() % 32, len);
+                string copy(len + 1, '!');
+                InternetChecksum check{0, kernel};
+                for (size_t start = 0; start < len;) {
+                    const size_t piece = min(len - start, uniform_int_distribution<size_t>{0, 100}(rd));
+                    check.copy_and_add(data.substr(start, piece), copy.data() + start);
+                    start += piece;
+                }
+                if (check.value() != reference_checksum(data) or copy != string(data) + '!') {
+                    throw runtime_error(kernel_name(kernel) + " kernel copied or summed " + to_string(len) +
+                                        " bytes wrongly");
+                }
+            }
+        }
+
+        // sums that fold to 0xffff, or that are zero, give the same checksum whichever kernel makes them
+        for (const auto kernel : kernels) {
+            for (const char byte : {'\0', '\xff'}) {
+                const string data(65536 + 3, byte);
+                if (checksum(kernel, data, {1, 4000}) != reference_checksum(data)) {
+                    throw runtime_error(kernel_name(kernel) + " kernel got the wrong checksum for bytes of " +
+                                        to_string(uint8_t(byte)));
+                }
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
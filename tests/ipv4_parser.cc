@@ -233,6 +233,7 @@ int main(int argc, char **argv) {
                 ipv4_hdr_copy.len -= 4 * ipv4_hdr_orig.hlen - IPv4Header::LENGTH;
                 ipv4_hdr_copy.hlen = 5;
                 ipv4_hdr_copy.len -= 4 * tcp_hdr_orig.doff - TCPHeader::LENGTH;
+                tcp_hdr_copy.options = {};
                 tcp_hdr_copy.doff = 5;
             }  // ipv4_hdr_{orig,copy}, tcp_hdr_{orig,copy} go out of scope
 
@@ -0,0 +1,141 @@
+#include "byte_stream.hh"
+#include "stream_reassembler.hh"
+#include "tcp_config.hh"
+#include "tcp_receiver.hh"
+#include "tcp_segment.hh"
+#include "wrapping_integers.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static const WrappingInt32 isn{0};
+static const size_t rtt = 10;
+
+static TCPConfig config() {
+    TCPConfig cfg;
+    cfg.recv_capacity = 4000;
+    cfg.recv_capacity_max = 64000;
+    cfg.recv_autotuning = true;
+    return cfg;
+}
+
+static TCPSegment segment(const uint64_t stream_index, const string &data, const bool syn = false) {
+    TCPSegment seg;
+    seg.header().syn = syn;
+    seg.header().seqno = wrap(syn ? 0 : stream_index + 1, isn);
+    seg.payload() = string(data);
+    return seg;
+}
+
+//! One RTT of a sender that always fills the window: the whole window arrives, in 1000-byte segments
+static void receive_window(TCPReceiver &receiver) {
+    receiver.tick(rtt);
+    const uint64_t first = receiver.stream_out().bytes_written();
+    const size_t window = receiver.window_size();
+    for (size_t sent = 0; sent < window; sent += 1000) {
+        receiver.segment_received(segment(first + sent, string(min<size_t>(1000, window - sent), 'x')));
+    }
+}
+
+static void expect_capacity(const TCPReceiver &receiver, const size_t expected, const string &when) {
+    if (receiver.capacity() != expected) {
+        throw runtime_error("capacity is " + to_string(receiver.capacity()) + " " + when + ", not " +
+                            to_string(expected));
+    }
+}
+
+int main() {
+    try {
+        // a ring-stored stream keeps its bytes, in order, when resized, and never shrinks below them
+        {
+            ByteStream stream{8};
+            stream.write("abcdef");
+            stream.pop_output(4);
+            stream.write("ghij");
+            stream.set_capacity(16);
+            if (stream.peek_output(6) != "efghij" or stream.remaining_capacity() != 10) {
+                throw runtime_error("ring lost bytes when it grew");
+            }
+            stream.set_capacity(2);
+            if (stream.peek_output(6) != "efghij" or stream.remaining_capacity() != 0) {
+                throw runtime_error("ring dropped below the bytes it holds");
+            }
+        }
+
+        // both reassembly engines keep the substrings waiting for earlier bytes
+        for (const auto engine : {StreamReassembler::Engine::Map, StreamReassembler::Engine::Bitmap}) {
+            StreamReassembler reassembler{8, engine};
+            reassembler.push_substring("cd", 2, false);
+            reassembler.push_substring("gh", 6, false);
+            reassembler.set_capacity(32);
+            reassembler.push_substring("ijkl", 8, false);
+            reassembler.push_substring("ab", 0, false);
+            reassembler.push_substring("ef", 4, false);
+            if (reassembler.stream_out().read(12) != "abcdefghijkl" or not reassembler.empty()) {
+                throw runtime_error("reassembler lost bytes when it grew");
+            }
+            reassembler.push_substring("mn", 12, false);
+            reassembler.push_substring("pq", 15, false);
+            reassembler.set_capacity(1);
+            if (reassembler.first_unacceptable() != 17) {
+                throw runtime_error("reassembler shrank below the bytes it holds");
+            }
+            reassembler.push_substring("o", 14, false);
+            if (reassembler.stream_out().read(5) != "mnopq") {
+                throw runtime_error("reassembler lost bytes when it shrank");
+            }
+        }
+
+        // an application that keeps up grows the window to the maximum, which then shrinks back once idle: not
+        // by pulling in its right edge, but by keeping it where it was as the application reads
+        {
+            TCPReceiver receiver{config()};
+            receiver.segment_received(segment(0, "", true));
+            for (size_t round = 0; round < 8; ++round) {
+                receive_window(receiver);
+                receiver.stream_out().pop_output(receiver.stream_out().buffer_size());
+            }
+            expect_capacity(receiver, 64000, "with a fast reader");
+            if (receiver.window_size() != 64000) {
+                throw runtime_error("window did not grow with the capacity");
+            }
+
+            receiver.tick(1000);
+            const uint64_t right_edge = receiver.stream_out().bytes_written() + receiver.window_size();
+            if (receiver.window_size() != 64000) {
+                throw runtime_error("window's right edge was pulled in after a second without data");
+            }
+            for (size_t i = 0; i < 100 and receiver.capacity() > 4000; ++i) {
+                receiver.segment_received(segment(receiver.stream_out().bytes_written(), string(1000, 'x')));
+                receiver.stream_out().pop_output(1000);
+                const uint64_t edge = receiver.stream_out().bytes_written() + receiver.window_size();
+                if (edge < right_edge or (receiver.capacity() > 4000 and edge != right_edge)) {
+                    throw runtime_error("window's right edge moved while the window shrank");
+                }
+            }
+            expect_capacity(receiver, 4000, "once the application read the window it had");
+        }
+
+        // an application that reads nothing keeps the window where it started
+        {
+            TCPReceiver receiver{config()};
+            receiver.segment_received(segment(0, "", true));
+            for (size_t round = 0; round < 8; ++round) {
+                receive_window(receiver);
+            }
+            expect_capacity(receiver, 4000, "with a reader that reads nothing");
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
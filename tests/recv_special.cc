@@ -140,6 +140,20 @@ int main() {
             test.execute(ExpectBytes{"Hello and goodbye, CS144!"});
             test.execute(ExpectEof{});
         }
+
+        /* segments after the seqno wraps around */
+        {
+            const uint32_t isn = UINT32_MAX - 2;
+            TCPReceiverTestHarness test{4000};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectAckno{WrappingInt32{isn + 5}});
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 5).with_data("efgh").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectAckno{WrappingInt32{isn + 9}});
+            test.execute(ExpectBytes{"abcdefgh"});
+        }
     } catch (const exception &e) {
         cerr << e.what() << endl;
         return 1;
@@ -0,0 +1,120 @@
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static const WrappingInt32 isn{0};
+
+static void drain(TCPSender &sender) {
+    while (not sender.segments_out().empty()) {
+        sender.segments_out().pop();
+    }
+}
+
+//! Send `data`, let `rtt` ms pass and acknowledge it
+static void round_trip(TCPSender &sender, const string &data, const uint64_t rtt) {
+    sender.stream_in().write(data);
+    sender.fill_window();
+    drain(sender);
+    sender.tick(rtt);
+    sender.ack_received(wrap(sender.next_seqno_absolute(), isn), 1000);
+}
+
+static TCPSender connected_sender(const TCPConfig &cfg, const uint64_t rtt) {
+    TCPSender sender{cfg};
+    sender.fill_window();
+    drain(sender);
+    sender.tick(rtt);
+    sender.ack_received(wrap(1, isn), 1000);
+    return sender;
+}
+
+int main() {
+    try {
+        TCPConfig cfg;
+        cfg.fixed_isn = isn;
+        cfg.adaptive_rto = true;
+
+        // SRTT, RTTVAR and the RTO follow RFC 6298, and ACKs of retransmitted segments give no sample and
+        // keep the backoff (Karn)
+        {
+            TCPSender sender = connected_sender(cfg, 100);
+            if (sender.smoothed_rtt() != 100 or sender.rtt_variation() != 50 or
+                sender.retransmission_timeout() != 300) {
+                throw runtime_error("first RTT sample did not set SRTT = R, RTTVAR = R/2, RTO = SRTT + 4 * RTTVAR");
+            }
+
+            sender.stream_in().write("abc");
+            sender.fill_window();
+            drain(sender);
+            sender.tick(299);
+            if (not sender.segments_out().empty()) {
+                throw runtime_error("retransmitted before the estimated RTO");
+            }
+            sender.tick(1);
+            if (sender.segments_out().size() != 1 or sender.retransmission_timeout() != 600) {
+                throw runtime_error("did not retransmit and back off at the estimated RTO");
+            }
+            drain(sender);
+
+            sender.ack_received(wrap(4, isn), 1000);
+            if (sender.smoothed_rtt() != 100 or sender.rtt_variation() != 50) {
+                throw runtime_error("ACK of a retransmitted segment changed the estimates");
+            }
+            if (sender.retransmission_timeout() != 600) {
+                throw runtime_error("ACK of a retransmitted segment cleared the RTO backoff");
+            }
+
+            round_trip(sender, "d", 60);
+            if (sender.smoothed_rtt() != 95 or sender.rtt_variation() != 47.5 or
+                sender.retransmission_timeout() != 285) {
+                throw runtime_error("second RTT sample was not smoothed correctly, or did not clear the backoff");
+            }
+
+            for (unsigned i = 0; i < 100; ++i) {
+                round_trip(sender, "e", 1);
+            }
+            if (sender.retransmission_timeout() != cfg.rt_timeout_min) {
+                throw runtime_error("RTO fell below its lower bound");
+            }
+        }
+
+        // backoff stops at the upper bound
+        {
+            TCPConfig bounded = cfg;
+            bounded.rt_timeout_max = 500;
+            TCPSender sender = connected_sender(bounded, 100);
+            sender.stream_in().write("abc");
+            sender.fill_window();
+            drain(sender);
+            sender.tick(300);
+            sender.tick(500);
+            if (sender.consecutive_retransmissions() != 2 or sender.retransmission_timeout() != 500) {
+                throw runtime_error("RTO backoff exceeded its upper bound");
+            }
+        }
+
+        // without adaptive_rto, the RTT is still measured but the RTO stays fixed
+        {
+            TCPConfig fixed = cfg;
+            fixed.adaptive_rto = false;
+            TCPSender sender = connected_sender(fixed, 100);
+            if (sender.smoothed_rtt() != 100 or sender.retransmission_timeout() != fixed.rt_timeout) {
+                throw runtime_error("fixed RTO was changed by an RTT sample");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+#include "congestion_controller.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t MSS = 1000;
+
+static AckEvent ack_of(const uint64_t bytes_acked, const uint64_t now = 0) {
+    AckEvent ack;
+    ack.now = now;
+    ack.bytes_acked = bytes_acked;
+    return ack;
+}
+
+int main() {
+    try {
+        // Reno: slow start, halving on loss, additive increase, collapse on timeout
+        {
+            RenoController reno{MSS};
+            if (reno.cwnd() != 4 * MSS) {
+                throw runtime_error("Reno's initial window is not RFC 5681's");
+            }
+            reno.on_ack(ack_of(2 * MSS));
+            reno.on_ack(ack_of(MSS));
+            if (reno.cwnd() != 6 * MSS) {
+                throw runtime_error("Reno did not grow by one segment per ACK in slow start");
+            }
+
+            reno.on_loss(0, 10 * MSS);
+            if (reno.cwnd() != 5 * MSS or reno.ssthresh() != 5 * MSS) {
+                throw runtime_error("Reno did not halve its window on loss");
+            }
+            for (unsigned i = 0; i < 5; ++i) {
+                reno.on_ack(ack_of(MSS));
+            }
+            if (reno.cwnd() != 6 * MSS) {
+                throw runtime_error("Reno did not grow by one segment per window in congestion avoidance");
+            }
+
+            reno.on_rto(0, 6 * MSS);
+            if (reno.cwnd() != MSS or reno.ssthresh() != 3 * MSS) {
+                throw runtime_error("Reno did not collapse to one segment on timeout");
+            }
+        }
+
+        // CUBIC: reduces by beta, then climbs back to the previous maximum, flattens out and probes beyond it
+        {
+            CubicController cubic{MSS};
+            while (cubic.cwnd() < 200 * MSS) {
+                cubic.on_ack(ack_of(MSS));
+            }
+            cubic.on_loss(0, cubic.cwnd());
+            if (cubic.cwnd() != 140 * MSS) {
+                throw runtime_error("CUBIC did not reduce its window to beta * W_max");
+            }
+
+            // a 100 ms RTT path, with a window's worth of ACKs every RTT; K = cbrt(60 / 0.4) = 5.3 s
+            uint64_t cwnd_at_1s = 0, cwnd_at_4s = 0, cwnd_at_6s = 0;
+            for (uint64_t now = 0; now <= 8000; now += 100) {
+                AckEvent ack = ack_of(cubic.cwnd(), now);
+                ack.rtt = 100;
+                cubic.on_ack(ack);
+                cwnd_at_1s = now == 1000 ? cubic.cwnd() : cwnd_at_1s;
+                cwnd_at_4s = now == 4000 ? cubic.cwnd() : cwnd_at_4s;
+                cwnd_at_6s = now == 6000 ? cubic.cwnd() : cwnd_at_6s;
+            }
+            if (cwnd_at_1s <= 160 * MSS or cwnd_at_1s >= 200 * MSS) {
+                throw runtime_error("CUBIC did not grow quickly towards W_max");
+            }
+            if (cwnd_at_6s - cwnd_at_4s > 2 * MSS) {
+                throw runtime_error("CUBIC did not flatten out near W_max");
+            }
+            if (cubic.cwnd() <= 205 * MSS) {
+                throw runtime_error("CUBIC did not probe beyond W_max");
+            }
+        }
+
+        // BBR: a steady 200 bytes/ms over a 50 ms RTT converges on a window of about two BDPs (20 kB), whatever
+        // the phase of the probing cycle
+        {
+            BBRController bbr{MSS};
+            constexpr uint64_t RATE = 200, RTT = 50;
+            for (uint64_t now = RTT; now < 5000; ++now) {
+                AckEvent ack = ack_of(RATE, now);
+                ack.delivered = RATE * (now - RTT + 1);
+                ack.sent_at = now - RTT;
+                ack.delivered_at_send = ack.delivered - RATE * RTT;
+                ack.bytes_in_flight = RATE * RTT;
+                ack.rtt = RTT;
+                bbr.on_ack(ack);
+                if (now >= 4000 and bbr.cwnd() != 2 * RATE * RTT) {
+                    throw runtime_error("BBR's window followed the probing cycle's pacing gain");
+                }
+            }
+            if (bbr.mode() != BBRController::Mode::ProbeBW) {
+                throw runtime_error("BBR did not leave startup once the bandwidth stopped growing");
+            }
+            if (bbr.btl_bw() != RATE) {
+                throw runtime_error("BBR's bandwidth estimate is incorrect");
+            }
+            if (bbr.cwnd() < 15000 or bbr.cwnd() > 25000) {
+                throw runtime_error("BBR's window is not near twice the bandwidth-delay product");
+            }
+        }
+
+        // BBR: the window never shrinks in startup, and drain lowers only the pacing rate, not the window
+        {
+            BBRController bbr{MSS};
+            constexpr uint64_t RATE = 200, RTT = 50;
+            // without a path model, the window grows past where the first model puts startup's target
+            for (uint64_t now = 0; now < 50; ++now) {
+                bbr.on_ack(ack_of(1000, now));
+            }
+            for (uint64_t now = RTT; bbr.mode() != BBRController::Mode::Drain and now < 5000; ++now) {
+                AckEvent ack = ack_of(RATE, now);
+                ack.delivered = RATE * (now - RTT + 1);
+                ack.sent_at = now - RTT;
+                ack.delivered_at_send = ack.delivered - RATE * RTT;
+                ack.bytes_in_flight = 3 * RATE * RTT;  // a queue, so BBR stays in drain
+                ack.rtt = RTT;
+                const uint64_t before = bbr.cwnd();
+                bbr.on_ack(ack);
+                if (bbr.mode() == BBRController::Mode::Startup and bbr.cwnd() < before) {
+                    throw runtime_error("BBR's window shrank during startup");
+                }
+            }
+            if (bbr.mode() != BBRController::Mode::Drain) {
+                throw runtime_error("BBR did not leave startup once the bandwidth stopped growing");
+            }
+            if (bbr.cwnd() < 2 * RATE * RTT or bbr.pacing_rate(RTT) >= RATE) {
+                throw runtime_error("BBR's drain lowered the window rather than the pacing rate");
+            }
+        }
+
+        // the TCPSender never has more than the congestion window in flight
+        {
+            TCPConfig cfg;
+            cfg.congestion_control = TCPConfig::CongestionControl::Reno;
+            cfg.fixed_isn = WrappingInt32{0};
+            TCPSender sender{cfg};
+            const auto drain = [&] {
+                while (not sender.segments_out().empty()) {
+                    sender.segments_out().pop();
+                }
+            };
+
+            sender.fill_window();
+            sender.ack_received(WrappingInt32{1}, 60000);
+            drain();
+            const uint64_t initial_cwnd = sender.congestion_controller()->cwnd();
+
+            sender.stream_in().write(string(30000, 'x'));
+            sender.fill_window();
+            drain();
+            if (sender.bytes_in_flight() != initial_cwnd) {
+                throw runtime_error("TCPSender did not fill the congestion window");
+            }
+
+            sender.ack_received(wrap(1 + sender.bytes_in_flight(), WrappingInt32{0}), 60000);
+            sender.fill_window();
+            drain();
+            const uint64_t cwnd = sender.congestion_controller()->cwnd();
+            if (cwnd <= initial_cwnd or sender.bytes_in_flight() != cwnd) {
+                throw runtime_error("TCPSender did not use the grown congestion window");
+            }
+
+            sender.tick(TCPConfig::TIMEOUT_DFLT);
+            if (sender.segments_out().size() != 1 or sender.congestion_controller()->cwnd() != MSS) {
+                throw runtime_error("timeout did not collapse the congestion window");
+            }
+        }
+
+        // without congestion control, only the receiver's window limits the TCPSender
+        {
+            TCPSender sender{TCPConfig::DEFAULT_CAPACITY, TCPConfig::TIMEOUT_DFLT, WrappingInt32{0}};
+            sender.fill_window();
+            sender.ack_received(WrappingInt32{1}, 60000);
+            sender.stream_in().write(string(30000, 'x'));
+            sender.fill_window();
+            if (sender.congestion_controller() != nullptr or sender.bytes_in_flight() != 30000) {
+                throw runtime_error("TCPSender without congestion control did not fill the receiver's window");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+#include "congestion_controller.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static const WrappingInt32 isn{0};
+static const uint16_t window = 10000;
+
+static void drain(TCPSender &sender) {
+    while (not sender.segments_out().empty()) {
+        sender.segments_out().pop();
+    }
+}
+
+//! A connected sender with `bytes` sent in full-size segments, none of them acknowledged
+static TCPSender sender_with_data(const TCPConfig &cfg, const size_t bytes) {
+    TCPSender sender{cfg};
+    sender.fill_window();
+    sender.ack_received(wrap(1, isn), window);
+    sender.stream_in().write(string(bytes, 'x'));
+    sender.fill_window();
+    drain(sender);
+    return sender;
+}
+
+//! Expect exactly one segment, a retransmission starting at `seqno`
+static void expect_retransmission(TCPSender &sender, const uint64_t seqno, const string &when) {
+    if (sender.segments_out().size() != 1 or sender.segments_out().front().header().seqno != wrap(seqno, isn)) {
+        throw runtime_error("did not retransmit the segment at " + to_string(seqno) + " " + when);
+    }
+    drain(sender);
+}
+
+static void expect_nothing_sent(TCPSender &sender, const string &when) {
+    if (not sender.segments_out().empty()) {
+        throw runtime_error("sent a segment " + when);
+    }
+}
+
+int main() {
+    try {
+        TCPConfig cfg;
+        cfg.fixed_isn = isn;
+        cfg.fast_retransmit = true;
+
+        // the third duplicate ACK retransmits the first unacknowledged segment, once; partial ACKs
+        // retransmit the next one until everything sent before recovery began is acknowledged
+        {
+            TCPSender sender = sender_with_data(cfg, 5000);
+            sender.ack_received(wrap(1001, isn), window);
+            sender.ack_received(wrap(1001, isn), window);
+            sender.ack_received(wrap(1001, isn), window);
+            expect_nothing_sent(sender, "after two duplicate ACKs");
+            sender.ack_received(wrap(1001, isn), window);
+            expect_retransmission(sender, 1001, "on the third duplicate ACK");
+            sender.ack_received(wrap(1001, isn), window);
+            expect_nothing_sent(sender, "on the fourth duplicate ACK");
+
+            sender.ack_received(wrap(2001, isn), window);
+            expect_retransmission(sender, 2001, "on a partial ACK");
+            sender.ack_received(wrap(5001, isn), window);
+            expect_nothing_sent(sender, "on the ACK ending recovery");
+            if (sender.fast_retransmissions() != 2 or sender.consecutive_retransmissions() != 0) {
+                throw runtime_error("wrong count of fast retransmissions");
+            }
+        }
+
+        // ACKs carrying data, or changing the window, are not duplicates
+        {
+            TCPSender sender = sender_with_data(cfg, 5000);
+            for (unsigned i = 0; i < 3; ++i) {
+                sender.ack_received(wrap(1, isn), window, false);
+            }
+            sender.ack_received(wrap(1, isn), window - 1);
+            sender.ack_received(wrap(1, isn), window);
+            sender.ack_received(wrap(1, isn), window - 1);
+            expect_nothing_sent(sender, "on ACKs that were not duplicates");
+        }
+
+        // without fast_retransmit, repeated ACKs are harmless
+        {
+            TCPConfig off = cfg;
+            off.fast_retransmit = false;
+            TCPSender sender = sender_with_data(off, 5000);
+            for (unsigned i = 0; i < 10; ++i) {
+                sender.ack_received(wrap(1, isn), window);
+            }
+            expect_nothing_sent(sender, "on duplicate ACKs with fast retransmit off");
+        }
+
+        // the congestion controller learns of the loss: Reno halves its window
+        {
+            TCPConfig reno = cfg;
+            reno.congestion_control = TCPConfig::CongestionControl::Reno;
+            TCPSender sender = sender_with_data(reno, 8000);
+            for (unsigned i = 0; i < 3; ++i) {
+                sender.ack_received(wrap(1, isn), window);
+            }
+            expect_retransmission(sender, 1, "with Reno");
+            if (sender.congestion_controller()->cwnd() != 2000) {
+                throw runtime_error("Reno did not halve its window on fast retransmit");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
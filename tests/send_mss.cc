@@ -0,0 +1,113 @@
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const WrappingInt32 isn{0};
+static const size_t window = 100000;
+
+//! A sender whose SYN has been acknowledged, with a window of 100 kB
+static TCPSender connected_sender(const TCPConfig &cfg) {
+    TCPSender sender{cfg};
+    sender.fill_window();
+    sender.segments_out().pop();
+    sender.ack_received(wrap(1, isn), window);
+    return sender;
+}
+
+//! \returns the payload sizes of the segments sent since the last call
+static vector<size_t> sent_sizes(TCPSender &sender) {
+    vector<size_t> ret;
+    while (not sender.segments_out().empty()) {
+        ret.push_back(sender.segments_out().front().payload().size());
+        sender.segments_out().pop();
+    }
+    return ret;
+}
+
+static void expect_sizes(TCPSender &sender, const vector<size_t> &expected, const string &when) {
+    const vector<size_t> sizes = sent_sizes(sender);
+    if (sizes != expected) {
+        string got;
+        for (const size_t size : sizes) {
+            got += " " + to_string(size);
+        }
+        throw runtime_error("sent segments of" + got + " bytes " + when);
+    }
+}
+
+int main() {
+    try {
+        TCPConfig cfg;
+        cfg.fixed_isn = isn;
+
+        // the peer's MSS caps the size of segments, but never raises it
+        {
+            TCPSender sender = connected_sender(cfg);
+            sender.set_peer_mss(536);
+            sender.stream_in().write(string(2000, 'x'));
+            sender.fill_window();
+            expect_sizes(sender, {536, 536, 536, 392}, "to a peer with an MSS of 536");
+
+            TCPSender other = connected_sender(cfg);
+            other.set_peer_mss(9000);
+            other.stream_in().write(string(2000, 'x'));
+            other.fill_window();
+            expect_sizes(other, {1000, 1000}, "to a peer with an MSS of 9000");
+        }
+
+        cfg.mss = 8960;
+        cfg.mtu_probing = true;
+
+        // a probe of the largest size goes out first; once it is acknowledged, that is the MSS
+        {
+            TCPSender sender = connected_sender(cfg);
+            sender.stream_in().write(string(11000, 'x'));
+            sender.fill_window();
+            expect_sizes(sender, {8960, 1000, 1000, 40}, "with probing from 1000 up to 8960");
+            sender.ack_received(wrap(sender.next_seqno_absolute(), isn), window);
+            if (sender.mss() != 8960) {
+                throw runtime_error("acknowledged probe raised the MSS to " + to_string(sender.mss()));
+            }
+            sender.stream_in().write(string(10000, 'x'));
+            sender.fill_window();
+            expect_sizes(sender, {8960, 1040}, "after a successful probe");
+        }
+
+        // a probe that times out is retransmitted in segments of the current MSS, and the next probe
+        // searches below it
+        {
+            TCPSender sender = connected_sender(cfg);
+            sender.stream_in().write(string(8960, 'x'));
+            sender.fill_window();
+            expect_sizes(sender, {8960}, "as a probe");
+            sender.tick(cfg.rt_timeout);
+            expect_sizes(sender, {1000}, "when the probe timed out");
+            sender.ack_received(wrap(1001, isn), window);
+            sender.tick(cfg.rt_timeout);
+            expect_sizes(sender, {1000}, "when the second piece timed out");
+            sender.ack_received(wrap(8961, isn), window);
+            if (sender.mss() != 1000 or sender.bytes_in_flight() != 0) {
+                throw runtime_error("lost probe changed the MSS to " + to_string(sender.mss()));
+            }
+
+            sender.stream_in().write(string(6000, 'x'));
+            sender.fill_window();
+            expect_sizes(sender, {4980, 1000, 20}, "on the next probe");
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
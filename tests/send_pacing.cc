@@ -0,0 +1,114 @@
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "wrapping_integers.hh"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static const WrappingInt32 isn{0};
+static const size_t window = 100000;
+
+//! \returns how many segments were sent since the last call
+static size_t sent(TCPSender &sender) {
+    size_t ret = 0;
+    for (; not sender.segments_out().empty(); ++ret) {
+        sender.segments_out().pop();
+    }
+    return ret;
+}
+
+static void expect_sent(TCPSender &sender, const size_t expected, const string &when) {
+    if (const size_t count = sent(sender); count != expected) {
+        throw runtime_error("sent " + to_string(count) + " segments " + when + ", not " + to_string(expected));
+    }
+}
+
+static void expect_wait(const TCPSender &sender, const optional<double> expected, const string &when) {
+    const optional<double> wait = sender.time_until_next_send();
+    if (wait.has_value() != expected.has_value() or
+        (wait.has_value() and abs(wait.value() - expected.value()) > 1e-9)) {
+        throw runtime_error("wrong time until the next send " + when);
+    }
+}
+
+int main() {
+    try {
+        TCPConfig cfg;
+        cfg.fixed_isn = isn;
+        cfg.pacing = true;
+
+        // at a fixed rate of 1.6 segments per ms, segments fall due between ticks, and each tick sends
+        // the ones that have come due since the last
+        {
+            TCPConfig fixed = cfg;
+            fixed.pacing_rate = 1'600'000;
+            TCPSender sender{fixed};
+            sender.fill_window();
+            sender.ack_received(wrap(1, isn), window);
+            expect_sent(sender, 1, "for the SYN");
+
+            sender.stream_in().write(string(16000, 'x'));
+            sender.fill_window();
+            expect_sent(sender, 1, "at first");
+            expect_wait(sender, 0.625, "after the first segment");
+            sender.tick(1);
+            expect_sent(sender, 1, "in the first ms");
+            expect_wait(sender, 0.25, "after the first ms");
+            sender.tick(1);
+            expect_sent(sender, 2, "in the second ms");
+            sender.tick(4);
+            expect_sent(sender, 6, "in the next 4 ms");
+
+            // once everything has been sent and acknowledged, a pause earns no burst
+            sender.tick(4);
+            expect_sent(sender, 6, "for the rest of the data");
+            expect_wait(sender, {}, "with nothing held back");
+            sender.ack_received(wrap(16001, isn), window);
+            sender.tick(100);
+            sender.stream_in().write(string(3000, 'x'));
+            sender.fill_window();
+            expect_sent(sender, 1, "after a pause");
+        }
+
+        // with congestion control, the rate is twice the window per smoothed RTT during slow start
+        {
+            TCPConfig reno = cfg;
+            reno.congestion_control = TCPConfig::CongestionControl::Reno;
+            TCPSender sender{reno};
+            sender.fill_window();
+            sender.tick(10);
+            sender.ack_received(wrap(1, isn), window);
+            expect_sent(sender, 1, "for the SYN");
+
+            sender.stream_in().write(string(4000, 'x'));
+            sender.fill_window();
+            expect_sent(sender, 1, "in slow start");
+            const double rate = 2.0 * sender.congestion_controller()->cwnd() / sender.smoothed_rtt().value();
+            expect_wait(sender, 1000 / rate, "in slow start");
+        }
+
+        // without an RTT sample there is nothing to pace by, so the whole window goes at once
+        {
+            TCPSender sender{cfg};
+            sender.fill_window();
+            sender.segments_out().pop();
+            sender.stream_in().write(string(4000, 'x'));
+            sender.ack_received(wrap(1, isn), window);
+            sender.fill_window();
+            expect_sent(sender, 4, "before an RTT sample");
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+#include "tcp_config.hh"
+#include "tcp_options.hh"
+#include "tcp_sender.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static const WrappingInt32 isn{0};
+static const uint16_t window = 10000;
+
+static void drain(TCPSender &sender) {
+    while (not sender.segments_out().empty()) {
+        sender.segments_out().pop();
+    }
+}
+
+//! A connected sender with `bytes` sent in full-size segments, none of them acknowledged
+static TCPSender sender_with_data(const TCPConfig &cfg, const size_t bytes) {
+    TCPSender sender{cfg};
+    sender.fill_window();
+    sender.ack_received(wrap(1, isn), window);
+    sender.stream_in().write(string(bytes, 'x'));
+    sender.fill_window();
+    drain(sender);
+    return sender;
+}
+
+//! Deliver an ACK for `ackno` carrying SACK blocks of absolute seqnos, as TCPConnection would
+static void sack_and_ack(TCPSender &sender,
+                         const uint64_t ackno,
+                         const initializer_list<pair<uint64_t, uint64_t>> blocks) {
+    TCPOptions options;
+    for (const auto &[left, right] : blocks) {
+        options.add_sack_block(wrap(left, isn), wrap(right, isn));
+    }
+    sender.sack_received(options);
+    sender.ack_received(wrap(ackno, isn), window);
+    sender.fill_window();
+}
+
+//! Expect exactly the retransmissions starting at `seqnos`, in order
+static void expect_retransmissions(TCPSender &sender, const vector<uint64_t> &seqnos, const string &when) {
+    for (const uint64_t seqno : seqnos) {
+        if (sender.segments_out().empty() or sender.segments_out().front().header().seqno != wrap(seqno, isn)) {
+            throw runtime_error("did not retransmit the segment at " + to_string(seqno) + " " + when);
+        }
+        sender.segments_out().pop();
+    }
+    if (not sender.segments_out().empty()) {
+        throw runtime_error("sent too many segments " + when);
+    }
+}
+
+int main() {
+    try {
+        TCPConfig cfg;
+        cfg.fixed_isn = isn;
+        cfg.fast_retransmit = true;
+
+        // two holes: recovery starts as soon as more than two segments' worth is SACKed above the
+        // first, and both holes are repaired within the same round trip
+        {
+            TCPSender sender = sender_with_data(cfg, 8000);
+            sack_and_ack(sender, 1, {{1001, 2001}});
+            expect_retransmissions(sender, {}, "after one SACKed segment");
+            sack_and_ack(sender, 1, {{3001, 5001}, {1001, 2001}});
+            expect_retransmissions(sender, {1}, "once three segments were SACKed after the first");
+            sack_and_ack(sender, 1, {{3001, 8001}, {1001, 2001}});
+            expect_retransmissions(sender, {2001}, "once three segments were SACKed after the second hole");
+            if (sender.sacked_bytes() != 6000) {
+                throw runtime_error("scoreboard holds " + to_string(sender.sacked_bytes()) + " SACKed bytes");
+            }
+
+            // nothing is retransmitted twice, and nothing SACKed is retransmitted at all
+            sack_and_ack(sender, 1, {{3001, 8001}, {1001, 2001}});
+            sender.fill_window();
+            expect_retransmissions(sender, {}, "after both holes were repaired");
+            sack_and_ack(sender, 8001, {});
+            expect_retransmissions(sender, {}, "on the ACK ending recovery");
+            if (sender.fast_retransmissions() != 2 or sender.sacked_bytes() != 0 or sender.bytes_in_flight() != 0) {
+                throw runtime_error("scoreboard not cleared when recovery ended");
+            }
+        }
+
+        // a partial ACK leaves the next hole for the scoreboard to repair, even when too little was
+        // SACKed above it to presume it lost
+        {
+            TCPSender sender = sender_with_data(cfg, 5000);
+            sack_and_ack(sender, 1, {{1001, 2001}});
+            sack_and_ack(sender, 1, {{3001, 4001}, {1001, 2001}});
+            sack_and_ack(sender, 1, {{3001, 5001}, {1001, 2001}});
+            expect_retransmissions(sender, {1}, "when the first segment was presumed lost");
+            sack_and_ack(sender, 2001, {{3001, 5001}});
+            expect_retransmissions(sender, {2001}, "on a partial ACK");
+            sack_and_ack(sender, 5001, {});
+            expect_retransmissions(sender, {}, "on the ACK ending recovery");
+        }
+
+        // after a timeout, the scoreboard still drives the repairs: a lost retransmission is sent again
+        // as soon as an ACK arrives, rather than one hole per timeout
+        {
+            TCPSender sender = sender_with_data(cfg, 8000);
+            sack_and_ack(sender, 1, {{3001, 5001}, {1001, 2001}});
+            sack_and_ack(sender, 1, {{3001, 8001}, {1001, 2001}});
+            expect_retransmissions(sender, {1, 2001}, "when recovery began");
+
+            // both retransmissions are lost
+            sender.tick(TCPConfig::TIMEOUT_DFLT);
+            expect_retransmissions(sender, {1}, "on the timeout");
+            sack_and_ack(sender, 1001, {{3001, 8001}});
+            expect_retransmissions(sender, {2001}, "on the first ACK after the timeout");
+            sack_and_ack(sender, 8001, {});
+            expect_retransmissions(sender, {}, "once everything was acknowledged");
+            if (sender.bytes_in_flight() != 0 or sender.fast_retransmissions() != 2) {
+                throw runtime_error("repairs after the timeout were counted as fast retransmissions");
+            }
+        }
+
+        // blocks that are below the cumulative ACK, or beyond what was sent, are ignored
+        {
+            TCPSender sender = sender_with_data(cfg, 5000);
+            sack_and_ack(sender, 2001, {});
+            sack_and_ack(sender, 2001, {{1, 1001}, {6001, 7001}});
+            if (sender.sacked_bytes() != 0) {
+                throw runtime_error("scoreboard accepted a block outside the outstanding data");
+            }
+            sack_and_ack(sender, 2001, {{2501, 3001}});
+            if (sender.sacked_bytes() != 0) {
+                throw runtime_error("scoreboard counted a segment that was only partly SACKed");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
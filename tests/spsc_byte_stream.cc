@@ -0,0 +1,76 @@
+#include "spsc_byte_stream.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            SPSCByteStream stream{8};
+            if (stream.write("abcdef") != 6 or stream.read(4) != "abcd") {
+                throw runtime_error("write/read returned the wrong bytes");
+            }
+            // wraps around the end of the ring
+            if (stream.write("ghijklmn") != 6 or stream.remaining_capacity() != 0 or stream.buffer_size() != 8) {
+                throw runtime_error("write did not stop at capacity");
+            }
+            if (stream.read(100) != "efghijkl" or stream.bytes_read() != 12 or stream.bytes_written() != 12) {
+                throw runtime_error("read across the wrap returned the wrong bytes");
+            }
+            stream.end_input();
+            if (not stream.eof()) {
+                throw runtime_error("drained stream with ended input is not at eof");
+            }
+        }
+
+        {
+            // a small ring and odd write/read sizes, so both sides repeatedly fill, drain and sleep
+            constexpr size_t total = 16 * 1024 * 1024;
+            SPSCByteStream stream{4093};
+
+            string data(total, 0);
+            mt19937 rd{12345};
+            for (auto &ch : data) {
+                ch = static_cast<char>(rd());
+            }
+
+            thread writer([&] {
+                size_t written = 0;
+                while (written < total) {
+                    const size_t n = stream.write(data.data() + written, min(total - written, size_t(1 + rd() % 3000)));
+                    if (n == 0) {
+                        stream.wait_until_writable();
+                    }
+                    written += n;
+                }
+                stream.end_input();
+            });
+
+            string received;
+            received.reserve(total);
+            char buf[2500];
+            while (not stream.eof()) {
+                const size_t n = stream.read_into(buf, sizeof(buf));
+                if (n == 0) {
+                    stream.wait_until_readable();
+                }
+                received.append(buf, n);
+            }
+            writer.join();
+
+            if (received != data) {
+                throw runtime_error("bytes received by the reader thread don't match");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
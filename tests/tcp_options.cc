@@ -0,0 +1,141 @@
+#include "parser.hh"
+#include "tcp_header.hh"
+#include "tcp_options.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//! A header with the given option bytes (`doff` set to cover them) and a valid checksum
+static string raw_segment(const vector<uint8_t> &option_bytes) {
+    vector<uint8_t> seg{0x04, 0x00, 0x00, 0x50, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0x02, 0xff, 0xff, 0, 0, 0, 0};
+    seg.insert(seg.end(), option_bytes.begin(), option_bytes.end());
+    seg[12] = (seg.size() / 4) << 4;
+    InternetChecksum check;
+    check.add({reinterpret_cast<const char *>(seg.data()), seg.size()});
+    const uint16_t cksum = check.value();
+    seg[16] = cksum >> 8;
+    seg[17] = cksum & 0xff;
+    return {seg.begin(), seg.end()};
+}
+
+static TCPSegment parse_segment(string data, const ParseResult expected = ParseResult::NoError) {
+    TCPSegment seg;
+    if (const auto res = seg.parse(move(data)); res != expected) {
+        throw runtime_error("expected " + as_string(expected) + " but got " + as_string(res));
+    }
+    return seg;
+}
+
+static TCPSegment round_trip(const TCPSegment &seg) { return parse_segment(seg.serialize().concatenate()); }
+
+int main() {
+    try {
+        // the standard options, in the layout Linux puts on a SYN
+        {
+            const TCPSegment seg = parse_segment(raw_segment({0x02, 0x04, 0x05, 0xb4,  // MSS 1460
+                                                              0x04, 0x02,              // SACK permitted
+                                                              0x08, 0x0a, 0, 0, 0, 7, 0, 0, 0, 0,  // TS 7, 0
+                                                              0x01,                                // NOP
+                                                              0x03, 0x03, 0x07}));                 // WS 7
+            const TCPOptions &options = seg.header().options;
+            if (options.mss != 1460 or options.window_scale != 7 or not options.sack_permitted or
+                not options.timestamps.has_value() or options.timestamps.value().value != 7 or
+                options.timestamps.value().echo_reply != 0 or options.sack_block_count != 0 or
+                not options.unknown().empty()) {
+                throw runtime_error("bad parse of SYN options:" + options.to_string());
+            }
+            const TCPSegment copy = round_trip(seg);
+            if (not(copy.header() == seg.header()) or copy.header().doff != 10) {
+                throw runtime_error("SYN options did not survive a round trip");
+            }
+        }
+
+        // options set in code: doff follows them, and the checksum covers them
+        {
+            TCPSegment seg;
+            seg.header().ack = true;
+            seg.header().options.timestamps = TCPOptions::Timestamps{123456789, 987654321};
+            seg.header().options.add_sack_block(WrappingInt32{1000}, WrappingInt32{2000});
+            seg.header().options.add_sack_block(WrappingInt32{3000}, WrappingInt32{4000});
+            seg.header().options.add_sack_block(WrappingInt32{5000}, WrappingInt32{6000});
+            seg.payload() = string("hello");
+
+            bool threw = false;
+            try {
+                seg.serialize();
+            } catch (const runtime_error &) {
+                threw = true;
+            }
+            if (not threw) {
+                throw runtime_error("serialized options that do not fit in doff");
+            }
+
+            seg.header().update_doff();
+            if (seg.header().doff != 14) {
+                throw runtime_error("update_doff() gave " + to_string(seg.header().doff) + ", not 14");
+            }
+            const TCPSegment copy = round_trip(seg);
+            if (copy.header().options != seg.header().options or copy.payload().str() != "hello") {
+                throw runtime_error("SACK and timestamps did not survive a round trip:" +
+                                    copy.header().options.to_string());
+            }
+            string corrupted = seg.serialize().concatenate();
+            corrupted[TCPHeader::LENGTH + 3] ^= 0x10;
+            parse_segment(corrupted, ParseResult::BadChecksum);
+
+            seg.header().options = {};
+            seg.header().update_doff();
+            if (seg.header().doff != 5 or seg.serialize().concatenate().size() != TCPHeader::LENGTH + 5) {
+                throw runtime_error("removing the options did not shrink the header");
+            }
+        }
+
+        // options of unknown kinds, or known kinds with the wrong length, are kept as they are
+        {
+            const TCPSegment seg = parse_segment(raw_segment({0x1e, 0x04, 0xab, 0xcd,  // kind 30 (MPTCP)
+                                                              0x02, 0x03, 0x05,        // MSS with length 3
+                                                              0x00}));                 // END
+            const TCPOptions &options = seg.header().options;
+            if (options.mss.has_value() or options.unknown() != string("\x1e\x04\xab\xcd\x02\x03\x05", 7)) {
+                throw runtime_error("unknown options were not preserved:" + options.to_string());
+            }
+            const TCPSegment copy = round_trip(seg);
+            if (copy.header().options != options or copy.header().doff != 7) {
+                throw runtime_error("unknown options did not survive a round trip");
+            }
+        }
+
+        // at most four SACK blocks
+        {
+            TCPOptions options;
+            for (unsigned i = 0; i < TCPOptions::MAX_SACK_BLOCKS; ++i) {
+                if (not options.add_sack_block(WrappingInt32{i}, WrappingInt32{i + 1})) {
+                    throw runtime_error("no room for SACK block " + to_string(i));
+                }
+            }
+            if (options.add_sack_block(WrappingInt32{10}, WrappingInt32{11}) or options.length() != 36) {
+                throw runtime_error("room for too many SACK blocks");
+            }
+        }
+
+        // options whose length is impossible
+        parse_segment(raw_segment({0x02, 0x00, 0x01, 0x01}), ParseResult::TruncatedPacket);
+        parse_segment(raw_segment({0x01, 0x01, 0x08, 0x0a, 0, 0, 0, 0}), ParseResult::TruncatedPacket);
+        parse_segment(raw_segment({0x01, 0x01, 0x01, 0x05}), ParseResult::TruncatedPacket);
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -197,6 +197,7 @@ int main(int argc, char **argv) {
                 TCPHeader &tcp_hdr_copy = tcp_seg_copy.header();
                 tcp_hdr_copy = tcp_hdr_orig;
                 // fix up segment to remove IPv4 and TCP header extensions
+                tcp_hdr_copy.options = {};
                 tcp_hdr_copy.doff = 5;
             }  // tcp_hdr_{orig,copy} go out of scope
 
@@ -230,6 +231,21 @@ int main(int argc, char **argv) {
                 ok = false;
                 continue;
             }
+
+            // the original segment, options and all, also survives a round trip
+            TCPSegment tcp_seg_copy3;
+            if (const auto res = tcp_seg_copy3.parse(tcp_seg.serialize().concatenate()); res != ParseResult::NoError) {
+                cout << "ERROR got parse failure " << as_string(res) << " for this segment with options:\n";
+                hexdump(tcp_seg_data, tcp_seg_len);
+                ok = false;
+                continue;
+            }
+            if (!compare_tcp_headers(tcp_seg.header(), tcp_seg_copy3.header()) ||
+                tcp_seg.header().options != tcp_seg_copy3.header().options) {
+                cout << "ERROR: after re-parsing, TCP options don't match.\n";
+                ok = false;
+                continue;
+            }
         }
 
         pcap_close(pcap);
@@ -0,0 +1,219 @@
+#include "address.hh"
+#include "ipv4_datagram.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+//! A segment with random header fields, options and a payload of `len` bytes
+static TCPSegment random_segment(mt19937 &rd, const size_t len) {
+    TCPSegment seg;
+    TCPHeader &header = seg.header();
+    header.seqno = WrappingInt32{uint32_t(rd())};
+    header.ackno = WrappingInt32{uint32_t(rd())};
+    header.ack = rd() % 2;
+    header.psh = rd() % 2;
+    header.win = rd();
+    if (rd() % 2) {
+        header.options.mss = 1460;
+        header.options.add_sack_block(WrappingInt32{uint32_t(rd())}, WrappingInt32{uint32_t(rd())});
+    }
+    header.update_doff();
+
+    string payload(len, 0);
+    for (auto &byte : payload) {
+        byte = char(rd());
+    }
+    seg.payload() = move(payload);
+    return seg;
+}
+
+//! \returns whether `f` throws std::out_of_range
+template <typename F>
+static bool out_of_room(const F &f) {
+    try {
+        f();
+    } catch (const out_of_range &) {
+        return true;
+    }
+    return false;
+}
+
+//! An adapter between two fixed addresses
+class Adapter : public TCPOverIPv4Adapter {
+  public:
+    Adapter() {
+        config_mutable().source = {"10.0.0.1", 1234};
+        config_mutable().destination = {"10.0.0.2", 80};
+    }
+};
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        Adapter adapter;
+
+        for (size_t trial = 0; trial < 1000; ++trial) {
+            const size_t len = uniform_int_distribution<size_t>{0, 1460}(rd);
+            TCPSegment seg = random_segment(rd, len);
+
+            // serializing into a packet buffer gives the same bytes as the BufferList, leaving the headroom
+            // in front of them for the lower layers
+            const uint32_t pseudo_cksum = rd() % 0x40000;
+            PacketBuffer packet{len};
+            seg.serialize(packet, pseudo_cksum);
+            if (packet.str() != seg.serialize(pseudo_cksum).concatenate()) {
+                throw runtime_error("segment serialized into a buffer differs, with " + to_string(len) + " bytes");
+            }
+            if (packet.headroom() != PacketBuffer::DEFAULT_HEADROOM - 4 * seg.header().doff or packet.tailroom()) {
+                throw runtime_error("segment took the wrong room in the packet buffer");
+            }
+
+            // and so does a whole IPv4 datagram, which parses with both checksums correct
+            const PacketBuffer datagram = adapter.serialize_tcp_in_ip(seg);
+            if (datagram.str() != adapter.wrap_tcp_in_ip(seg).serialize().concatenate()) {
+                throw runtime_error("datagram serialized into a buffer differs, with " + to_string(len) + " bytes");
+            }
+            InternetDatagram ip_dgram;
+            if (const auto res = ip_dgram.parse(string(datagram.str())); res != ParseResult::NoError) {
+                throw runtime_error("could not parse the datagram: " + as_string(res));
+            }
+            TCPSegment parsed;
+            if (const auto res = parsed.parse(ip_dgram.payload(), ip_dgram.header().pseudo_cksum());
+                res != ParseResult::NoError) {
+                throw runtime_error("could not parse the segment: " + as_string(res));
+            }
+            if (parsed.payload().str() != seg.payload().str() or parsed.header().seqno != seg.header().seqno) {
+                throw runtime_error("segment did not survive the round trip");
+            }
+        }
+
+        // headers pushed in front of a payload make one packet, which becomes a Buffer without a copy
+        {
+            PacketBuffer packet{40, 6};
+            packet.put(5)[0] = 'h';
+            copy_n("ello", 4, packet.data() + 1);
+            copy_n("abc", 3, packet.push(3));
+            packet.pull(1);
+            copy_n("XYZ", 3, packet.push(3));
+            if (packet.str() != "XYZbchello" or packet.headroom() != 1 or packet.tailroom() != 35) {
+                throw runtime_error("packet buffer holds the wrong bytes");
+            }
+            if (not out_of_room([&] { packet.push(3); }) or not out_of_room([&] { packet.put(36); }) or
+                not out_of_room([&] { packet.pull(11); })) {
+                throw runtime_error("packet buffer overflowed");
+            }
+            const char *const bytes = packet.data();
+            const Buffer buffer = packet.release();
+            if (buffer.str() != "XYZbchello" or buffer.str().data() != bytes or packet.size() != 0) {
+                throw runtime_error("packet buffer did not become a Buffer without a copy");
+            }
+        }
+
+        // adjusting a checksum for a changed word or pair of words gives the checksum of the changed data
+        for (size_t trial = 0; trial < 10000; ++trial) {
+            string data(uniform_int_distribution<size_t>{2, 64}(rd) * 2, 0);
+            for (auto &byte : data) {
+                byte = char(rd() % 4 == 0 ? 0xff : rd());
+            }
+            InternetChecksum before;
+            before.add(data);
+            const size_t offset = rd() % (data.size() / 2 - 1) * 2;
+            const uint32_t old_value = (uint8_t(data[offset]) << 24) | (uint8_t(data[offset + 1]) << 16) |
+                                       (uint8_t(data[offset + 2]) << 8) | uint8_t(data[offset + 3]);
+            const uint32_t new_value = rd() % 2 ? uint32_t(rd()) : old_value ^ 0xffff;
+            for (size_t i = 0; i < 4; ++i) {
+                data[offset + i] = char(new_value >> (24 - 8 * i));
+            }
+            InternetChecksum after;
+            after.add(data);
+            if (InternetChecksum::adjust(before.value(), old_value, new_value) != after.value()) {
+                throw runtime_error("adjusted checksum differs from the checksum of the changed data");
+            }
+        }
+
+        // decrementing the TTL keeps the IPv4 header checksum valid
+        {
+            TCPSegment seg = random_segment(rd, 100);
+            InternetDatagram ip_dgram;
+            ip_dgram.parse(string(adapter.serialize_tcp_in_ip(seg).str()));
+            for (size_t hop = 0; hop < 3; ++hop) {
+                ip_dgram.header().decrement_ttl();
+            }
+            InternetChecksum check;
+            check.add(ip_dgram.header().serialize());
+            if (ip_dgram.header().ttl != IPv4Header::DEFAULT_TTL - 3 or check.value() != 0) {
+                throw runtime_error("TTL decrement left a bad header checksum");
+            }
+
+            ip_dgram.header().ttl = 0;
+            const uint16_t cksum = ip_dgram.header().cksum;
+            if (ip_dgram.header().decrement_ttl() or ip_dgram.header().ttl != 0 or ip_dgram.header().cksum != cksum) {
+                throw runtime_error("TTL of 0 was decremented");
+            }
+        }
+
+        // so do a parsed segment's setters, and a copy of a segment with a cached checksum serializes to the
+        // same bytes as a fresh segment, whatever changed since the checksum was cached
+        for (size_t trial = 0; trial < 1000; ++trial) {
+            TCPSegment seg = random_segment(rd, uniform_int_distribution<size_t>{0, 1460}(rd));
+            const uint32_t pseudo_cksum = rd() % 0x40000;
+            TCPSegment parsed;
+            parsed.parse(seg.serialize(pseudo_cksum).concatenate(), pseudo_cksum);
+            parsed.header().set_ports(rd(), rd());
+            parsed.header().set_ackno(WrappingInt32{uint32_t(rd())});
+            parsed.header().set_win(rd());
+            string raw = parsed.header().serialize();
+            raw.append(parsed.payload().str());
+            InternetChecksum check{pseudo_cksum};
+            check.add(raw);
+            if (check.value() != 0) {
+                throw runtime_error("header setters left a bad checksum");
+            }
+
+            seg.cache_checksum();
+            seg.serialize(pseudo_cksum);
+            TCPSegment retransmission = seg;
+            switch (rd() % 4) {
+                case 0:
+                    retransmission.header().ackno = WrappingInt32{uint32_t(rd())};
+                    retransmission.header().win = rd();
+                    break;
+                case 1:
+                    retransmission.header().ack = not retransmission.header().ack;
+                    break;
+                case 2:
+                    retransmission.payload().remove_prefix(retransmission.payload().size() / 2);
+                    break;
+                default:
+                    retransmission.header().options.add_sack_block(WrappingInt32{1}, WrappingInt32{2});
+                    retransmission.header().update_doff();
+            }
+            TCPSegment fresh;
+            fresh.header() = retransmission.header();
+            fresh.payload() = retransmission.payload().copy();
+            PacketBuffer packet{retransmission.payload().size()};
+            retransmission.serialize(packet, pseudo_cksum);
+            if (packet.str() != fresh.serialize(pseudo_cksum).concatenate() or
+                retransmission.serialize(pseudo_cksum).concatenate() != packet.str()) {
+                throw runtime_error("segment with a cached checksum serialized differently");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}